@@ -0,0 +1,210 @@
+/**
+ * @file bench_export.cpp
+ * @author ZHENG Robert (robert.hase-zheng.net)
+ * @brief end-to-end export throughput of the plugin, loaded like the host does
+ * @version 0.1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2025 ZHENG Robert
+ *
+ * usage: bench_export [--dir D] [--formats F,...] <plugin> <corpus.jsonl>
+ * replays a corpus of rz_corpus against every output format and reports per format
+ * records/s, MB/s of output, p50/p99 latency per record and the peak RSS of the process;
+ * the output goes to tmpfs (/dev/shm) unless --dir is given
+ *
+ */
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QHash>
+#include <QPluginLoader>
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "includes/rz_config.hpp"
+#include "includes/rz_photo-gallery_plugins.hpp"
+
+using json = nlohmann::json;
+
+namespace
+{
+constexpr std::array<const char *, 4> sectionNames{"PICTURE", "EXIF", "IPTC", "XMP"};
+
+struct Record
+{
+    QString image;
+    std::array<QHash<QString, QString>, sectionNames.size()> sections;
+};
+
+std::vector<Record> loadCorpus(const QString &path)
+{
+    std::vector<Record> records;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return records;
+    }
+    while (!file.atEnd())
+    {
+        const QByteArray line = file.readLine();
+        const json parsed = json::parse(line.constData(), line.constData() + line.size(), nullptr, false);
+        if (!parsed.is_object())
+        {
+            continue;
+        }
+        Record record;
+        for (std::size_t s = 0; s < sectionNames.size(); ++s)
+        {
+            const auto section = parsed.find(sectionNames[s]);
+            if (section == parsed.end() || !section->is_object())
+            {
+                continue;
+            }
+            for (auto it = section->cbegin(); it != section->cend(); ++it)
+            {
+                const std::string value = it.value().is_string() ? it.value().get<std::string>()
+                                                                  : it.value().dump();
+                record.sections[s].insert(QString::fromStdString(it.key()), QString::fromStdString(value));
+            }
+        }
+        record.image = QStringLiteral("/images/") + record.sections[0].value("file_name");
+        records.push_back(std::move(record));
+    }
+    return records;
+}
+
+long peakRssKiB()
+{
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+qint64 directoryBytes(const QString &dir)
+{
+    qint64 bytes = 0;
+    QDirIterator it(dir, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext())
+    {
+        it.next();
+        bytes += it.fileInfo().size();
+    }
+    return bytes;
+}
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("bench_export");
+    QCoreApplication::setApplicationVersion(QString::fromStdString(PROJECT_VERSION));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("replay a metadata corpus through the plugin for every output format");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("plugin", "plugin library, e.g. build/librz_write_json.so");
+    parser.addPositionalArgument("corpus", "corpus of rz_corpus, JSON Lines");
+    const QCommandLineOption dirOption({"d", "dir"}, "output directory", "dir", "/dev/shm/rz_bench_export");
+    const QCommandLineOption formatsOption({"f", "formats"},
+                                           "comma separated output formats",
+                                           "F,...",
+                                           "JSON,BSON,CBOR,MSGPACK,UBJSON,BJDATA");
+    parser.addOption(dirOption);
+    parser.addOption(formatsOption);
+    parser.process(app);
+
+    const QStringList args = parser.positionalArguments();
+    if (args.size() != 2)
+    {
+        parser.showHelp(EXIT_FAILURE);
+    }
+
+    QPluginLoader loader(args.at(0));
+    Plugin *plugin = qobject_cast<Plugin *>(loader.instance());
+    if (plugin == nullptr)
+    {
+        std::cerr << std::format("unable to load {}: {}\n",
+                                 args.at(0).toStdString(),
+                                 loader.errorString().toStdString());
+        return EXIT_FAILURE;
+    }
+
+    const std::vector<Record> corpus = loadCorpus(args.at(1));
+    if (corpus.empty())
+    {
+        std::cerr << std::format("no records in {}\n", args.at(1).toStdString());
+        return EXIT_FAILURE;
+    }
+    std::cout << std::format("{}: {} records, peak RSS after loading: {} MiB\n",
+                             plugin->getPluginVersion().toStdString(),
+                             corpus.size(),
+                             peakRssKiB() / 1024);
+
+    int failures = 0;
+    for (const QString &format : parser.value(formatsOption).split(',', Qt::SkipEmptyParts))
+    {
+        const QString dir = parser.value(dirOption) + "/" + format.toLower();
+        QDir(dir).removeRecursively();
+        QDir().mkpath(dir);
+
+        // a context of its own per format, as a host thread would use it
+        std::shared_ptr<Plugin> context = plugin->createContext();
+        Plugin *writer = context ? context.get() : plugin;
+        writer->setQstring("", format);
+
+        std::vector<double> latencies;
+        latencies.reserve(corpus.size());
+        int failed = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (const auto &record : corpus)
+        {
+            const auto begin = std::chrono::steady_clock::now();
+            writer->setQstring(record.image, "imgStruct");
+            for (std::size_t s = 0; s < sectionNames.size(); ++s)
+            {
+                writer->setQHash(record.sections[s], sectionNames[s]);
+            }
+            const auto [ok, msg] = writer->writeFile(dir);
+            latencies.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin)
+                                    .count());
+            failed += ok ? 0 : 1;
+        }
+        writer->doClose();
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::sort(latencies.begin(), latencies.end());
+        const auto percentile = [&latencies](double p) {
+            return latencies[std::min(latencies.size() - 1, static_cast<std::size_t>(p * latencies.size()))];
+        };
+        const double seconds = std::max(elapsed.count(), 1e-9);
+        const qint64 bytes = directoryBytes(dir);
+        std::cout << std::format("{:8} {:10.0f} records/s {:8.1f} MB/s  p50 {:8.1f} us  p99 {:8.1f} us  "
+                                 "peak RSS {} MiB  output {:.1f} MB  failed {}\n",
+                                 format.toStdString(),
+                                 corpus.size() / seconds,
+                                 bytes / 1e6 / seconds,
+                                 percentile(0.50),
+                                 percentile(0.99),
+                                 peakRssKiB() / 1024,
+                                 bytes / 1e6,
+                                 failed);
+        failures += failed;
+    }
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
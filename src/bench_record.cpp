@@ -0,0 +1,319 @@
+/**
+ * @file bench_record.cpp
+ * @author ZHENG Robert (robert.hase-zheng.net)
+ * @brief benchmark of the record storage: four QHash members vs. Rz_metaRecord
+ * @version 0.1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2025 ZHENG Robert
+ *
+ * usage: bench_record [records]
+ * reports per record: time, cache misses (perf_event_open, "n/a" if not permitted)
+ * and memory of retained records (heap in use and /proc/self/statm)
+ *
+ */
+
+#include <QHash>
+#include <QString>
+
+#include <linux/perf_event.h>
+#include <malloc.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "includes/rz_meta_record.hpp"
+
+namespace
+{
+using Section = std::vector<std::pair<std::string, std::string>>;
+using Input = std::array<Section, Rz_metaRecord::sectionCount>;
+
+const std::array<std::vector<std::string>, Rz_metaRecord::sectionCount> keys{{
+    {"file_name", "filesize", "filewidth", "fileheight", "filepath", "filedatetime", "access_groups"},
+    {"file_name", "gpstag", "imagedescription", "gpslongituderef", "gpsmapdatum", "imageuniqueid",
+     "imageid", "gpslatituderef", "usercomment", "gpsaltitude", "documentname", "gpstimestamp",
+     "copyright", "gpsaltituderef", "gpsdatestamp", "gpslongitude", "gpslatitude",
+     "datetimeoriginal", "securityclassification"},
+    {"file_name", "objectname", "copyright", "caption"},
+    {"file_name", "copyrightowner", "documentname", "zipcode", "language", "countrycode",
+     "localaddress", "sublocation", "category", "provincestate", "city", "imageid", "keywords",
+     "countryname", "streetname", "rights", "description", "title", "subject",
+     "securityclassification"},
+}};
+
+std::vector<Input> makeInputs(std::size_t count)
+{
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> length(4, 48);
+    std::uniform_int_distribution<int> letter(0, 27);
+
+    std::vector<Input> inputs(count);
+    for (auto &input : inputs)
+    {
+        for (std::size_t s = 0; s < Rz_metaRecord::sectionCount; ++s)
+        {
+            for (const auto &key : keys[s])
+            {
+                std::string value;
+                const int n = length(rng);
+                for (int i = 0; i < n; ++i)
+                {
+                    const int c = letter(rng);
+                    value += c == 26 ? "ä" : (c == 27 ? " " : std::string(1, static_cast<char>('a' + c)));
+                }
+                input[s].emplace_back(key, std::move(value));
+            }
+        }
+    }
+    return inputs;
+}
+
+QHash<QString, QString> toHash(const Section &section)
+{
+    QHash<QString, QString> hash;
+    for (const auto &[key, value] : section)
+    {
+        hash.insert(QString::fromStdString(key), QString::fromStdString(value));
+    }
+    return hash;
+}
+
+/**
+ * @brief The CacheMisses class
+ * @details hardware cache miss counter of this thread
+ */
+class CacheMisses
+{
+public:
+    CacheMisses()
+    {
+        perf_event_attr attr{};
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+    ~CacheMisses()
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+    }
+    void start()
+    {
+        if (fd >= 0)
+        {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+    long long stop()
+    {
+        long long count = -1;
+        if (fd >= 0)
+        {
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(fd, &count, sizeof(count)) != sizeof(count))
+            {
+                count = -1;
+            }
+        }
+        return count;
+    }
+
+private:
+    int fd{-1};
+};
+
+long heapBytes()
+{
+    return static_cast<long>(mallinfo2().uordblks);
+}
+
+long residentBytes()
+{
+    long pages = 0;
+    long resident = 0;
+    std::ifstream statm("/proc/self/statm");
+    statm >> pages >> resident;
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+/**
+ * @brief The HashRecord struct
+ * @details storage before Rz_metaRecord: one QHash per section
+ */
+struct HashRecord
+{
+    std::array<QHash<QString, QString>, Rz_metaRecord::sectionCount> sections;
+};
+
+// what writeFile did with the QHash members: sorted UTF-8 copies of every key and value
+std::size_t traverse(const HashRecord &record)
+{
+    std::size_t bytes = 0;
+    for (const auto &section : record.sections)
+    {
+        std::map<std::string, std::string> sorted;
+        for (auto i = section.cbegin(); i != section.cend(); ++i)
+        {
+            sorted.emplace(i.key().toStdString(), i.value().toStdString());
+        }
+        for (const auto &[key, value] : sorted)
+        {
+            bytes += key.size() + value.size();
+        }
+    }
+    return bytes;
+}
+
+std::size_t traverse(const Rz_metaRecord &record)
+{
+    std::size_t bytes = 0;
+    for (std::size_t s = 0; s < Rz_metaRecord::sectionCount; ++s)
+    {
+        for (const auto &entry : record.section(static_cast<Rz_section>(s)))
+        {
+            bytes += record.key(entry).size() + record.value(entry).size();
+        }
+    }
+    return bytes;
+}
+
+void fill(Rz_metaRecord &record, const std::array<QHash<QString, QString>, Rz_metaRecord::sectionCount> &hashes)
+{
+    record.clear();
+    for (std::size_t s = 0; s < Rz_metaRecord::sectionCount; ++s)
+    {
+        record.beginSection(static_cast<Rz_section>(s));
+        for (auto i = hashes[s].cbegin(); i != hashes[s].cend(); ++i)
+        {
+            record.add(std::u16string_view(reinterpret_cast<const char16_t *>(i.key().utf16()),
+                                           static_cast<std::size_t>(i.key().size())),
+                       std::u16string_view(reinterpret_cast<const char16_t *>(i.value().utf16()),
+                                           static_cast<std::size_t>(i.value().size())));
+        }
+        record.endSection();
+    }
+}
+
+void report(const char *name, std::size_t count, const std::function<std::size_t()> &run)
+{
+    CacheMisses misses;
+    const auto start = std::chrono::steady_clock::now();
+    misses.start();
+    const std::size_t bytes = run();
+    const long long missCount = misses.stop();
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << name << ": " << elapsed.count() / count << " ns/record, cache misses/record: ";
+    if (missCount < 0)
+    {
+        std::cout << "n/a";
+    }
+    else
+    {
+        std::cout << static_cast<double>(missCount) / count;
+    }
+    std::cout << " (" << bytes << " bytes)" << std::endl;
+}
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    const std::size_t count = std::max<std::size_t>(1, argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000);
+    const std::vector<Input> inputs = makeInputs(count);
+
+    // the host hands over fresh QHash objects per image
+    std::vector<std::array<QHash<QString, QString>, Rz_metaRecord::sectionCount>> hashes(count);
+    for (std::size_t r = 0; r < count; ++r)
+    {
+        for (std::size_t s = 0; s < Rz_metaRecord::sectionCount; ++s)
+        {
+            hashes[r][s] = toHash(inputs[r][s]);
+        }
+    }
+
+    // store and traverse, as setQHash() ... writeFile() per record
+    report("QHash members ", count, [&] {
+        HashRecord record;
+        std::size_t bytes = 0;
+        for (const auto &hash : hashes)
+        {
+            record.sections = hash;
+            bytes += traverse(record);
+        }
+        return bytes;
+    });
+    report("Rz_metaRecord ", count, [&] {
+        Rz_metaRecord record;
+        std::size_t bytes = 0;
+        for (const auto &hash : hashes)
+        {
+            fill(record, hash);
+            bytes += traverse(record);
+        }
+        return bytes;
+    });
+    hashes.clear();
+    hashes.shrink_to_fit();
+
+    // memory of retained records; freed memory is reused by later allocations,
+    // the heap counter is exact, the resident size is an upper bound
+    auto memory = [count](const char *name, long heap, long resident) {
+        std::cout << name << ": " << (heapBytes() - heap) / static_cast<long>(count)
+                  << " heap bytes/record, " << (residentBytes() - resident) / static_cast<long>(count)
+                  << " resident bytes/record" << std::endl;
+    };
+    {
+        const long heap = heapBytes();
+        const long resident = residentBytes();
+        std::vector<HashRecord> retained(count);
+        for (std::size_t r = 0; r < count; ++r)
+        {
+            for (std::size_t s = 0; s < Rz_metaRecord::sectionCount; ++s)
+            {
+                retained[r].sections[s] = toHash(inputs[r][s]);
+            }
+        }
+        memory("QHash members ", heap, resident);
+    }
+    {
+        const long heap = heapBytes();
+        const long resident = residentBytes();
+        std::vector<Rz_metaRecord> retained(count);
+        for (std::size_t r = 0; r < count; ++r)
+        {
+            for (std::size_t s = 0; s < Rz_metaRecord::sectionCount; ++s)
+            {
+                retained[r].beginSection(static_cast<Rz_section>(s));
+                for (const auto &[key, value] : inputs[r][s])
+                {
+                    retained[r].add(std::string_view(key), std::string_view(value));
+                }
+                retained[r].endSection();
+            }
+        }
+        memory("Rz_metaRecord ", heap, resident);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,154 @@
+/**
+ * @file rz_archive.hpp
+ * @author ZHENG Robert (robert.hase-zheng.net)
+ * @brief append-only archive of encoded records with background compaction
+ * @version 0.1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2025 ZHENG Robert
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include "rz_stream_encoder.hpp"
+
+/**
+ * @brief The Rz_archiveFrame struct
+ * @details one record or tombstone of a segment
+ *
+ * layout (little endian): size (u32, bytes after this field), type (u8), format (u8),
+ * key size (u16), key, payload, CRC-32 of type ... payload (u32)
+ */
+struct Rz_archiveFrame
+{
+  enum Type : std::uint8_t
+  {
+    Record,
+    Tombstone
+  };
+
+  Type type{Record};
+  OutputFormat format{OutputFormat::JSON};
+  std::string_view key;
+  std::string_view payload;
+  std::string_view bytes; // the complete frame
+};
+
+/**
+ * @brief The Rz_archive class
+ * @details records appended to segment files of a directory, the manifest lists the
+ * segments in order, the last one takes the appends. A later frame of a key supersedes
+ * the earlier ones. One instance per directory and process, thread-safe.
+ *
+ * Shared: other processes append to the same directory. Every append is a single
+ * O_APPEND write of a complete frame under a shared flock of the segment, so processes
+ * append in parallel; only manifest changes (new segment, compaction) take the
+ * exclusive lock file. A frame torn by a crashed process is skipped by its CRC.
+ */
+class Rz_archive
+{
+public:
+  static constexpr std::string_view manifestName{"archive.manifest"};
+  static constexpr std::string_view lockName{"archive.lock"};
+  static constexpr std::string_view compactLockName{"archive.compact.lock"};
+  static constexpr std::uint64_t segmentSize{64 * 1024 * 1024};
+  static constexpr std::uint64_t writeBehindBytes{8 * 1024 * 1024};
+
+  /**
+   * @brief open
+   * @param shared other processes append to the directory too; an instance opened
+   * shared stays shared
+   */
+  static std::shared_ptr<Rz_archive> open(const std::string &directory, bool shared = false);
+
+  explicit Rz_archive(std::string directory, bool shared = false);
+  ~Rz_archive();
+
+  Rz_archive(const Rz_archive &) = delete;
+  Rz_archive &operator=(const Rz_archive &) = delete;
+
+  bool isOpen() const { return activeFd >= 0; }
+
+  /**
+   * @brief setDirectIo
+   * @details bulk exports past the page cache: the compaction writes its segments with
+   * O_DIRECT (see Rz_directWriter), appends are handed to write-back every
+   * writeBehindBytes and dropped from the cache, a full segment as a whole
+   */
+  void setDirectIo(bool on) { directIo = on; }
+  const std::string &path() const { return directory; }
+
+  bool append(std::string_view key, OutputFormat format, std::string_view payload);
+  bool remove(std::string_view key);
+
+  /**
+   * @brief scan
+   * @details visits all valid frames in archive order, a torn frame ends its segment
+   */
+  bool scan(const std::function<void(const Rz_archiveFrame &)> &visit) const;
+
+  /**
+   * @brief startCompaction
+   * @details seals the current segments and rewrites their live records in key order
+   * into new segments on a background thread, then swaps them into the manifest;
+   * appends continue into a fresh segment meanwhile
+   * @param bytesPerSecond write rate limit, 0 = unlimited
+   * @return false if a compaction is already running, in this or another process
+   */
+  bool startCompaction(std::uint64_t bytesPerSecond);
+
+  bool compacting() const { return running; }
+
+  /**
+   * @brief report
+   * @return result of the last compaction, empty if none has finished
+   */
+  std::string report() const;
+
+private:
+  mutable std::mutex mutex;
+  std::string directory;
+  std::atomic<bool> shared;
+  std::vector<std::string> segments;
+  std::uint32_t nextSegment{1};
+  std::string activeSegment;
+  int activeFd{-1};
+  std::uint64_t activeSize{0};
+  std::atomic<bool> directIo{false};
+  std::uint64_t writebackStart{0}; // appends up to here are in write-back
+  std::uint64_t writebackDone{0};  // appends up to here are dropped from the cache
+  int lockFd{-1}; // lockName, held exclusively while the manifest changes
+  struct stat manifestStat{};
+
+  std::thread compactor;
+  int compactFd{-1}; // compactLockName, held while compacting
+  std::atomic<bool> running{false};
+  std::string lastReport;
+
+  bool appendFrame(Rz_archiveFrame::Type type, std::string_view key, OutputFormat format, std::string_view payload);
+  bool appendSharedLocked(std::string_view frame);
+  void writeBehindLocked();
+  bool openActiveLocked(bool create);
+  bool rotateLocked();
+  bool loadManifestLocked();
+  bool manifestChangedLocked() const;
+  bool refreshLocked();
+  bool storeManifestLocked(const std::vector<std::string> &list);
+  std::string newSegmentLocked();
+  std::string allocateSegmentLocked();
+  void compact(std::vector<std::string> sealed, std::uint64_t bytesPerSecond);
+};
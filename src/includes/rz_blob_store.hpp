@@ -0,0 +1,108 @@
+/**
+ * @file rz_blob_store.hpp
+ * @author ZHENG Robert (robert.hase-zheng.net)
+ * @brief content-addressed store of encoded sections, shared by identical records
+ * @version 0.1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2025 ZHENG Robert
+ *
+ * layout below the output directory:
+ *   .rz_blobs/<h[0..1]>/<sha256><ext>            a section, canonically encoded, stored once
+ *   .rz_blobs/refs/<xx>/<record>.<SECTION><ext>  hard link of the blob per reference
+ *
+ * The reference count of a blob is its link count minus one; it is kept by the file
+ * system, so it survives crashes and is safe between processes without a lock.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief The Rz_blobStore class
+ * @details one instance per directory and process, thread-safe
+ */
+class Rz_blobStore
+{
+public:
+  static constexpr std::string_view directoryName{".rz_blobs"};
+  // value of a section in the per-image manifest
+  static constexpr std::string_view referencePrefix{"sha256:"};
+
+  static std::shared_ptr<Rz_blobStore> open(const std::string &outputDirectory);
+
+  /**
+   * @brief digest
+   * @return SHA-256 of data, lower case hex
+   */
+  static std::string digest(std::string_view data);
+
+  explicit Rz_blobStore(std::string outputDirectory);
+
+  const std::string &path() const { return root; }
+
+  /**
+   * @brief put
+   * @details stores data unless a blob of the same digest exists and points the
+   * reference of record/section to it, replacing the previous reference
+   * @param extension of the output format, e.g. ".cbor"
+   * @param digest set to the digest of data
+   */
+  bool put(std::string_view record,
+           std::string_view section,
+           std::string_view extension,
+           std::string_view data,
+           std::string &digest,
+           std::string &error);
+
+  /**
+   * @brief get
+   * @details the blob of digest; if it was collected meanwhile, the reference of
+   * record/section if that still has the same content
+   */
+  bool get(std::string_view record,
+           std::string_view section,
+           std::string_view extension,
+           std::string_view digest,
+           std::string &data) const;
+
+  /**
+   * @brief release
+   * @details drops the reference of record/section in the output format of extension,
+   * the blob stays until collect()
+   */
+  bool release(std::string_view record, std::string_view section, std::string_view extension);
+
+  /**
+   * @brief references
+   * @return number of references to the blob, -1 if it doesn't exist
+   */
+  long references(std::string_view extension, std::string_view digest) const;
+
+  /**
+   * @brief collect
+   * @details removes the blobs without references
+   * @return number of removed blobs
+   */
+  std::uint64_t collect();
+
+  /**
+   * @brief report
+   * @return sections stored, deduplicated and the bytes saved since open()
+   */
+  std::string report() const;
+
+private:
+  std::string root;
+  std::atomic<std::uint64_t> stored{0};
+  std::atomic<std::uint64_t> deduplicated{0};
+  std::atomic<std::uint64_t> savedBytes{0};
+
+  std::string blobPath(std::string_view extension, std::string_view digest) const;
+  std::string referencePath(std::string_view record, std::string_view section, std::string_view extension) const;
+};
@@ -0,0 +1,64 @@
+/**
+ * @file rz_change_log.hpp
+ * @author ZHENG Robert (robert.hase-zheng.net)
+ * @brief change feed of an output folder: one delta per written record
+ * @version 0.1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2025 ZHENG Robert
+ *
+ * ".rz_changes.log" in the output folder, JSON Lines, only ever appended:
+ *   {"patch":[{"op":"replace","path":"/EXIF/gpslatitude","value":"48.1"}],"record":"IMG_1","time":1760000000000}
+ *   {"record":"IMG_2","removed":true,"time":1760000000001}
+ * "patch" is a JSON Patch (RFC 6902) from the previous export of the record to the new
+ * one; a new record is an "add" of every member. A consumer tails the file and keeps
+ * its byte offset as cursor.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief The Rz_changeLog class
+ * @details one instance per directory and process, thread-safe; every entry is a
+ * single O_APPEND write, entries of several processes never interleave
+ */
+class Rz_changeLog
+{
+public:
+  static constexpr std::string_view fileName{".rz_changes.log"};
+
+  static std::shared_ptr<Rz_changeLog> open(const std::string &directory);
+
+  /**
+   * @brief entry
+   * @return log line of the change from before to after, empty if they are equal
+   */
+  static std::string entry(std::string_view record, const nlohmann::json &before, const nlohmann::json &after);
+
+  /**
+   * @brief removal
+   * @return log line of a removed record
+   */
+  static std::string removal(std::string_view record);
+
+  explicit Rz_changeLog(std::string directory);
+  ~Rz_changeLog();
+
+  Rz_changeLog(const Rz_changeLog &) = delete;
+  Rz_changeLog &operator=(const Rz_changeLog &) = delete;
+
+  bool isOpen() const { return fd >= 0; }
+  const std::string &path() const { return filePath; }
+
+  bool append(std::string_view line);
+
+private:
+  std::string filePath;
+  int fd{-1};
+};
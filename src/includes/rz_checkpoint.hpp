@@ -0,0 +1,97 @@
+/**
+ * @file rz_checkpoint.hpp
+ * @author ZHENG Robert (robert.hase-zheng.net)
+ * @brief checkpoint journal of an output target: the records already exported
+ * @version 0.1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2025 ZHENG Robert
+ *
+ * ".rz_checkpoint" in the output folder, one output file name per line (basename and
+ * extension), only ever appended. Remove the file to start the export of the folder
+ * from scratch.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+/**
+ * @brief The Rz_checkpoint class
+ * @details one instance per directory and process, thread-safe. The journal is read
+ * once into a hash set, contains() needs neither the journal nor the output files.
+ * Completed records are collected in memory and appended in batches: every
+ * flushThreshold records or flushInterval. The file system is synced before a batch is
+ * written, so the journal never vouches for output still in the page cache; each batch
+ * is one O_APPEND write followed by fdatasync. A batch torn by a crash is cut when the
+ * journal is opened again; its records are exported once more.
+ */
+class Rz_checkpoint
+{
+public:
+  static constexpr std::string_view fileName{".rz_checkpoint"};
+  static constexpr std::size_t flushThreshold{1024};
+  static constexpr std::chrono::seconds flushInterval{2};
+
+  static std::shared_ptr<Rz_checkpoint> open(const std::string &directory);
+
+  explicit Rz_checkpoint(std::string directory);
+  ~Rz_checkpoint();
+
+  Rz_checkpoint(const Rz_checkpoint &) = delete;
+  Rz_checkpoint &operator=(const Rz_checkpoint &) = delete;
+
+  bool isOpen() const { return fd >= 0; }
+  const std::string &path() const { return filePath; }
+
+  /**
+   * @brief contains
+   * @return true if the record was completed by an earlier run; records completed by
+   * this run are written again when asked to
+   */
+  bool contains(const std::string &record) const;
+
+  /**
+   * @brief complete
+   * @details records the record as exported, flushes when a batch is due
+   */
+  void complete(const std::string &record);
+
+  /**
+   * @brief flush
+   * @details appends the collected records
+   * @return false if the journal could not be written
+   */
+  bool flush();
+
+  /**
+   * @brief report
+   * @return completed and skipped records
+   */
+  std::string report() const;
+
+  void skipped() { ++skippedRecords; }
+
+private:
+  std::string filePath;
+  int fd{-1};
+
+  mutable std::mutex mutex;
+  std::unordered_map<std::string, bool> records; // journalled, true: by an earlier run
+  std::size_t resumed{0};
+  std::string pending; // lines of the next batch
+  std::size_t pendingRecords{0};
+  std::chrono::steady_clock::time_point lastFlush;
+  std::atomic<std::uint64_t> skippedRecords{0};
+
+  void load();
+  bool flushLocked();
+};
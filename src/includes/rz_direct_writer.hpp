@@ -0,0 +1,101 @@
+/**
+ * @file rz_direct_writer.hpp
+ * @author ZHENG Robert (robert.hase-zheng.net)
+ * @brief large sequential files past the page cache
+ * @version 0.1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2025 ZHENG Robert
+ *
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+/**
+ * @brief The Rz_directWriter class
+ * @details packs the written bytes into aligned blocks, two buffers: one is filled while
+ * a thread writes the other. With O_DIRECT the blocks bypass the page cache; where the
+ * file system refuses O_DIRECT (tmpfs, some network file systems) every block is
+ * handed to write-back at once and dropped from the cache when the next one is written
+ * (sync_file_range, posix_fadvise). The last block is padded to the alignment and the
+ * file trimmed to its size on close().
+ */
+class Rz_directWriter
+{
+public:
+  static constexpr std::size_t alignment{4096};
+  static constexpr std::size_t blockSize{1024 * 1024};
+
+  /**
+   * @brief startWriteback
+   * @details starts the write-back of the range without waiting for it
+   */
+  static void startWriteback(int fd, std::uint64_t offset, std::uint64_t size);
+
+  /**
+   * @brief dropWritten
+   * @details waits for the write-back of the range and drops it from the page cache
+   */
+  static void dropWritten(int fd, std::uint64_t offset, std::uint64_t size);
+
+  Rz_directWriter() = default;
+  ~Rz_directWriter();
+
+  Rz_directWriter(const Rz_directWriter &) = delete;
+  Rz_directWriter &operator=(const Rz_directWriter &) = delete;
+
+  /**
+   * @brief open
+   * @details creates or truncates the file
+   * @param direct false: plain buffered writes in blocks, the page cache is kept
+   */
+  bool open(const std::string &path, bool direct = true);
+
+  bool write(std::string_view data);
+
+  /**
+   * @brief close
+   * @details writes the padded last block, trims the file to its size and syncs it
+   * @return false if any write failed
+   */
+  bool close();
+
+  bool isOpen() const { return fd >= 0; }
+  bool direct() const { return directIo; }
+  std::uint64_t size() const { return written; }
+
+private:
+  int fd{-1};
+  // set by the thread when the file system refuses O_DIRECT, read by direct() meanwhile
+  std::atomic<bool> directIo{false};   // O_DIRECT in use
+  std::atomic<bool> writeBehind{false}; // no O_DIRECT: write-back per block and drop
+  std::array<char *, 2> buffers{};
+  std::size_t current{0}; // buffer being filled
+  std::size_t filled{0};
+  std::uint64_t written{0}; // bytes accepted by write()
+  std::uint64_t offset{0};  // file offset of the next block
+
+  std::thread worker;
+  std::mutex mutex;
+  std::condition_variable changed;
+  const char *block{nullptr}; // block in flight
+  std::size_t blockBytes{0};
+  std::uint64_t blockOffset{0};
+  bool stopping{false};
+  bool failed{false};
+
+  bool submitBlock(std::size_t size);
+  bool waitIdle();
+  bool writeBlock(const char *data, std::size_t size, std::uint64_t at);
+  void run();
+};
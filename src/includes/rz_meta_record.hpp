@@ -0,0 +1,121 @@
+/**
+ * @file rz_meta_record.hpp
+ * @author ZHENG Robert (robert.hase-zheng.net)
+ * @brief compact storage of the PICTURE, EXIF, IPTC and XMP data of one record
+ * @version 0.1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2025 ZHENG Robert
+ *
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "rz_stream_encoder.hpp"
+
+/**
+ * @brief record sections, PICTURE are the top-level fields
+ */
+enum class Rz_section : std::uint8_t
+{
+  PICTURE,
+  EXIF,
+  IPTC,
+  XMP
+};
+
+/**
+ * @brief The Rz_metaRecord class
+ * @details all keys and values of a record in one contiguous UTF-8 buffer, indexed by
+ * a small offset array grouped by section and sorted by key (the order of the encoded
+ * output). clear() keeps the buffers for the next record unless they grew beyond
+ * retainCapacity. Offsets are 32 bit, a record holds up to maxBytes of keys and values.
+ */
+class Rz_metaRecord
+{
+public:
+  static constexpr std::size_t sectionCount{4};
+  static constexpr std::size_t retainCapacity{1024 * 1024};
+  static constexpr std::size_t maxBytes{std::numeric_limits<std::uint32_t>::max()};
+
+  struct Entry
+  {
+    std::uint32_t keyOffset;
+    std::uint32_t keySize;
+    std::uint32_t valueOffset;
+    std::uint32_t valueSize;
+  };
+
+  /**
+   * @brief beginSection
+   * @details start replacing the section, the old entries are dropped
+   */
+  void beginSection(Rz_section section);
+
+  /**
+   * @brief add
+   * @details add a key/value pair to the section started with beginSection()
+   * @return false if the record would exceed maxBytes, the pair is not added
+   */
+  bool add(const Rz_text &key, const Rz_text &value);
+
+  /**
+   * @brief endSection
+   * @details sort the new entries into the offset array, for duplicate keys the last one wins
+   */
+  void endSection();
+
+  /**
+   * @brief clear
+   * @details drop all data, the buffers are kept up to retainCapacity
+   */
+  void clear();
+
+  /**
+   * @brief release
+   * @details drop all data and free the buffers
+   */
+  void release();
+
+  bool empty() const { return entries.empty(); }
+  bool hasSection(Rz_section section) const { return present[index(section)]; }
+
+  std::span<const Entry> section(Rz_section section) const;
+  std::string_view key(const Entry &entry) const;
+  std::string_view value(const Entry &entry) const;
+
+  /**
+   * @brief find
+   * @return value of the key in the section (binary search)
+   */
+  std::optional<std::string_view> find(Rz_section section, std::string_view key) const;
+
+  /**
+   * @brief memoryUsage
+   * @return allocated bytes of buffer and offset array
+   */
+  std::size_t memoryUsage() const;
+
+private:
+  std::string buffer;
+  std::vector<Entry> entries;
+  std::array<std::uint32_t, sectionCount + 1> begin{};
+  std::array<bool, sectionCount> present{};
+
+  std::vector<Entry> pending;
+  Rz_section current{Rz_section::PICTURE};
+  std::size_t deadBytes{0};
+
+  static std::size_t index(Rz_section section) { return static_cast<std::size_t>(section); }
+  void compact();
+};
@@ -2,8 +2,8 @@
  * @file rz_photo-gallery_plugins.hpp
  * @author ZHENG Bote (robert.hase-zheng.net)
  * @brief QT plugin interface
- * @version 2.4.1
- * @date 2025-11-26
+ * @version 2.5.0
+ * @date 2026-10-19
  *
  * @copyright Copyright (c) 2023-2025 ZHENG Robert
  *
@@ -16,6 +16,7 @@
 #include <QMap>
 #include <QString>
 #include <QtPlugin>
+#include <memory>
 #include <string>
 #include <tuple>
 
@@ -94,7 +95,16 @@ public:
     virtual std::tuple<bool, std::string> setQHash(const QHash<QString, QString> &setQhash,
                                                    const QString &type = "") = 0;
     virtual QHash<QString, QString> getQHash(const QString &type = "") = 0;
+
+    /**
+     * @brief createContext
+     * @details factory for independent plugin instances, each owned and driven by
+     * one thread without locking; plugins without contexts return nullptr
+     * @return std::shared_ptr<Plugin> <new context or nullptr>
+     */
+    virtual std::shared_ptr<Plugin> createContext() { return nullptr; }
 };
 
-#define Plugin_iid "net.hase-zheng.photo_gallery_plugins"
+// 2.5: createContext() appended to the vtable, plugins built against 2.4 don't load
+#define Plugin_iid "net.hase-zheng.photo_gallery_plugins/2.5"
 Q_DECLARE_INTERFACE(Plugin, Plugin_iid)
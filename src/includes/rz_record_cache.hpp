@@ -0,0 +1,111 @@
+/**
+ * @file rz_record_cache.hpp
+ * @author ZHENG Robert (robert.hase-zheng.net)
+ * @brief read-through cache of decoded records
+ * @version 0.1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2025 ZHENG Robert
+ *
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "rz_meta_record.hpp"
+
+/**
+ * @brief The Rz_recordCache class
+ * @details decoded records of parseFile(), one instance per process shared by all
+ * contexts. The records are kept in their compact form (Rz_metaRecord) and keyed by
+ * path; an entry is only valid while inode, size and modification time of the file
+ * match. The memory cap is split over shards of their own lock and LRU list, the
+ * least recently used records of a shard are evicted first.
+ */
+class Rz_recordCache
+{
+public:
+  static constexpr std::size_t shardCount{16};
+
+  // identity of the file version a record was decoded from
+  struct Stamp
+  {
+    std::uint64_t inode{0};
+    std::uint64_t size{0};
+    std::int64_t modified{0}; // ns
+
+    bool operator==(const Stamp &) const = default;
+  };
+
+  static Rz_recordCache &instance();
+
+  /**
+   * @brief stamp
+   * @return false if the file doesn't exist
+   */
+  static bool stamp(const std::string &path, Stamp &stamp);
+
+  /**
+   * @brief setCapacity
+   * @details memory cap in bytes, 0 switches the cache off and drops all records
+   */
+  void setCapacity(std::size_t bytes);
+  std::size_t capacity() const { return capacityBytes.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief find
+   * @return the record decoded from this version of the file, nullptr if not cached
+   */
+  std::shared_ptr<const Rz_metaRecord> find(const std::string &path, const Stamp &stamp);
+
+  void insert(const std::string &path, const Stamp &stamp, std::shared_ptr<const Rz_metaRecord> record);
+
+  /**
+   * @brief invalidate
+   * @details drops the record of the file, called when it is rewritten
+   */
+  void invalidate(const std::string &path);
+
+  /**
+   * @brief report
+   * @return hits, misses, evictions, records and bytes held
+   */
+  std::string report() const;
+
+private:
+  struct Node
+  {
+    std::string path;
+    Stamp stamp;
+    std::shared_ptr<const Rz_metaRecord> record;
+    std::size_t bytes;
+  };
+
+  struct Shard
+  {
+    mutable std::mutex mutex;
+    std::list<Node> lru; // most recently used first
+    std::unordered_map<std::string, std::list<Node>::iterator> index;
+    std::size_t bytes{0};
+  };
+
+  std::array<Shard, shardCount> shards;
+  std::atomic<std::size_t> capacityBytes{0};
+  std::atomic<std::uint64_t> hits{0};
+  std::atomic<std::uint64_t> misses{0};
+  std::atomic<std::uint64_t> evictions{0};
+  std::atomic<std::uint64_t> invalidations{0};
+
+  Shard &shardOf(const std::string &path);
+  void eraseLocked(Shard &shard, std::list<Node>::iterator node);
+  void evictLocked(Shard &shard, std::size_t limit);
+};
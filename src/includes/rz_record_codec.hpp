@@ -0,0 +1,76 @@
+/**
+ * @file rz_record_codec.hpp
+ * @author ZHENG Robert (robert.hase-zheng.net)
+ * @brief decode exported records and feed them back into the stream encoder
+ * @version 0.1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2025 ZHENG Robert
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "rz_stream_encoder.hpp"
+
+/**
+ * @brief outputFormatFromName
+ * @param name <"JSON", "BSON", "CBOR", "MSGPACK", "UBJSON", "BJDATA">
+ */
+std::optional<OutputFormat> outputFormatFromName(std::string_view name);
+
+/**
+ * @brief outputFormatFromExtension
+ * @param ext <".json", ".bson", ".cbor", ".msgpack", ".ubjson", ".bjdata">
+ */
+std::optional<OutputFormat> outputFormatFromExtension(std::string_view ext);
+
+/**
+ * @brief outputFormatExtension
+ * @return <".json", ".bson", ...>
+ */
+std::string_view outputFormatExtension(OutputFormat fmt);
+
+/**
+ * @brief decodeRecord
+ * @details decode one exported record, never throws
+ * @return false if the data is not a valid object of the given format
+ */
+bool decodeRecord(OutputFormat fmt,
+                  const std::uint8_t *data,
+                  std::size_t size,
+                  nlohmann::json &record);
+
+/**
+ * @brief The Rz_recordNodes class
+ * @details stream encoder nodes of a decoded record, the nodes are views into
+ * the json object and stay valid as long as it is unchanged
+ */
+class Rz_recordNodes
+{
+public:
+  /**
+   * @brief assign
+   * @details nested objects become sections, other scalars are written as strings
+   * @return false if the record is not an object or contains arrays
+   */
+  bool assign(const nlohmann::json &record);
+
+  const std::vector<Rz_streamEncoder::Node> &root() const { return rootNodes; }
+
+private:
+  std::vector<Rz_streamEncoder::Node> rootNodes;
+  std::deque<std::vector<Rz_streamEncoder::Node>> sections;
+  std::deque<std::string> scalars;
+
+  bool assignObject(const nlohmann::json &object, std::vector<Rz_streamEncoder::Node> &nodes);
+};
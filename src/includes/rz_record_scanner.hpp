@@ -0,0 +1,52 @@
+/**
+ * @file rz_record_scanner.hpp
+ * @author ZHENG Robert (robert.hase-zheng.net)
+ * @brief locate the top-level members of an encoded record without decoding it
+ * @version 0.1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2025 ZHENG Robert
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "rz_stream_encoder.hpp"
+
+/**
+ * @brief The Rz_scanEntry struct
+ * @details position of one top-level member in the encoded record
+ */
+struct Rz_scanEntry
+{
+  std::string key;
+  std::size_t offset{0}; // first byte of the value
+  std::size_t size{0};   // bytes of the value
+  bool object{false};    // value is an object (EXIF, IPTC, XMP)
+  std::uint8_t bsonType{0}; // BSON element type, the value bytes don't carry it
+};
+
+/**
+ * @brief scanRecord
+ * @details walks the top-level object and skips the values by their length prefixes
+ * (BSON, CBOR, MessagePack, UBJSON, BJData) or by a lexical scan (JSON); values are
+ * not decoded. For BSON the value of an object is the embedded document, for the
+ * other formats the complete encoded object.
+ * @return false if the data is not a well-formed object of the format
+ */
+bool scanRecord(OutputFormat fmt, std::string_view data, std::vector<Rz_scanEntry> &entries);
+
+/**
+ * @brief decodeScalar
+ * @details the value of a scanned non-object member as UTF-8 text: strings are taken
+ * from the encoded bytes (unescaped for JSON), other scalars as their JSON text
+ * @param data the bytes given to scanRecord()
+ * @return false for objects, arrays and malformed values
+ */
+bool decodeScalar(OutputFormat fmt, std::string_view data, const Rz_scanEntry &entry, std::string &out);
@@ -0,0 +1,195 @@
+/**
+ * @file rz_search_index.hpp
+ * @author ZHENG Robert (robert.hase-zheng.net)
+ * @brief inverted index of selected metadata fields, written alongside the export
+ * @version 0.1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2025 ZHENG Robert
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief The Rz_searchIndexFile class
+ * @details read-only, memory mapped index file
+ *
+ * layout (little endian, no padding):
+ * - header:   magic "RZIX", version, record and term count, offsets of the areas
+ * - terms:    {termOffset, termSize, postingsOffset, postingsSize, records} sorted by
+ *             term, a term is "<field>\0<token>", e.g. "XMP.keywords\0beach"
+ * - records:  {nameOffset, nameSize}, index = record ID
+ * - postings: ascending record IDs as varint-coded gaps
+ * - strings:  terms and record names
+ * offsets into the strings, sizes and counts are 32-bit: the strings of one file are
+ * limited to 4 GiB, a larger index is not written
+ */
+class Rz_searchIndexFile
+{
+public:
+  Rz_searchIndexFile() = default;
+  ~Rz_searchIndexFile();
+  Rz_searchIndexFile(const Rz_searchIndexFile &) = delete;
+  Rz_searchIndexFile &operator=(const Rz_searchIndexFile &) = delete;
+
+  /**
+   * @brief open
+   * @return false if the file is missing or not a valid index
+   */
+  bool open(const std::string &path);
+  void close();
+  bool isOpen() const { return data != nullptr; }
+
+  std::uint32_t recordCount() const;
+  std::uint32_t termCount() const;
+  std::string_view recordName(std::uint32_t id) const;
+  std::string_view term(std::uint32_t index) const;
+  std::vector<std::uint32_t> postings(std::uint32_t index) const;
+
+  /**
+   * @brief findTerm
+   * @return index of the term (binary search)
+   */
+  std::optional<std::uint32_t> findTerm(std::string_view term) const;
+
+  /**
+   * @brief lookup
+   * @return record IDs containing the token in the field
+   */
+  std::vector<std::uint32_t> lookup(std::string_view field, std::string_view token) const;
+
+private:
+  const char *data{nullptr};
+  std::size_t size{0};
+};
+
+/**
+ * @brief The Rz_searchIndexReader class
+ * @details the index files of a directory, the base and its delta segments; a record
+ * is read from the newest file containing it, its entries in older files are stale
+ */
+class Rz_searchIndexReader
+{
+public:
+  /**
+   * @brief open
+   * @return false if the directory has no index
+   */
+  bool open(const std::string &directory);
+
+  /**
+   * @brief open
+   * @param paths index files, oldest first
+   * @return false if one of them is missing or not a valid index
+   */
+  bool open(const std::vector<std::string> &paths);
+
+  std::size_t fileCount() const { return files.size(); }
+  const Rz_searchIndexFile &file(std::size_t index) const { return *files[index]; }
+
+  /**
+   * @brief isLive
+   * @return false if a newer file contains the record too
+   */
+  bool isLive(std::size_t file, std::uint32_t id) const;
+
+  /**
+   * @brief lookup
+   * @return names of the records containing the token in the field, sorted
+   */
+  std::vector<std::string> lookup(std::string_view field, std::string_view token) const;
+
+  /**
+   * @brief lookup
+   * @param term "<field>\0<token>", see Rz_searchIndex::term()
+   * @return names of the records containing the term, sorted
+   */
+  std::vector<std::string> lookup(std::string_view term) const;
+
+private:
+  std::vector<std::unique_ptr<Rz_searchIndexFile>> files; // oldest first
+  std::unordered_map<std::string_view, std::size_t> newest; // record name -> file, all but the oldest
+};
+
+/**
+ * @brief The Rz_searchIndex class
+ * @details incremental index writer of one output directory, shared by all writer
+ * contexts exporting into it. New and re-exported records are collected in memory;
+ * flush() writes them as a delta segment ".rz_search.idx.<n>" next to the base
+ * ".rz_search.idx", a re-exported record supersedes its entries in older files. The
+ * newest files are then merged while the next older one is less than mergeRatio times
+ * their size, into the base once it is reached: an entry is rewritten O(log n) times
+ * and a directory holds O(log n) files. The sidecars are never read again.
+ */
+class Rz_searchIndex
+{
+public:
+  static constexpr std::string_view fileName{".rz_search.idx"};
+  static constexpr std::size_t flushThreshold{4096};
+  static constexpr std::uint64_t mergeRatio{2};
+
+  // field name ("XMP.keywords") and its UTF-8 value
+  using Field = std::pair<std::string_view, std::string_view>;
+
+  /**
+   * @brief open
+   * @details the index of the directory, one instance per directory and process
+   */
+  static std::shared_ptr<Rz_searchIndex> open(const std::string &directory);
+
+  explicit Rz_searchIndex(std::string directory);
+  ~Rz_searchIndex();
+
+  /**
+   * @brief add
+   * @details add or replace the record, flushes every flushThreshold records
+   * @return false if a due flush failed
+   */
+  bool add(std::string_view name, const std::vector<Field> &fields);
+
+  /**
+   * @brief search
+   * @details the written files and the records collected in memory, nothing is flushed
+   * @param query groups of terms, see term()
+   * @return names of the records containing a term of every group, sorted
+   */
+  std::vector<std::string> search(const std::vector<std::vector<std::string>> &query);
+
+  /**
+   * @brief flush
+   * @details write the collected records, the new segment is visible to readers afterwards
+   */
+  bool flush();
+
+  const std::string &path() const { return filePath; }
+
+  /**
+   * @brief tokenize
+   * @details ASCII letters and digits lower-cased, bytes of multibyte UTF-8 characters
+   * kept; everything else separates tokens
+   */
+  static void tokenize(std::string_view value, std::vector<std::string> &tokens);
+  static std::string term(std::string_view field, std::string_view token);
+
+private:
+  std::mutex mutex;
+  std::string directory;
+  std::string filePath; // the base
+  std::unordered_map<std::string, std::vector<std::string>> pending; // record name -> terms
+
+  bool flushLocked();
+  bool writeSegment();
+  bool mergeSegments();
+};
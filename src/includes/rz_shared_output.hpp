@@ -0,0 +1,89 @@
+/**
+ * @file rz_shared_output.hpp
+ * @author ZHENG Robert (robert.hase-zheng.net)
+ * @brief output files shared by several export processes
+ * @version 0.1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2025 ZHENG Robert
+ *
+ * A file is written under a name of its own (sharedTmpPath()) and renamed into place
+ * (publishFile()): readers and other writers see the old or the new file, never a
+ * truncated one, and the last complete write of a name wins. The file is synced before
+ * the rename, so that also holds after a crash. Nothing is locked for that; only
+ * updates of an existing file lock that one file (lockOutput()) and publish the
+ * updated file the same way.
+ */
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+/**
+ * @brief openShared
+ * @details the one instance of T for the directory in this process, shared by all
+ * writer contexts; created as T(directory, args...) while there is none and destroyed
+ * with its last user
+ */
+template<typename T, typename... Args>
+std::shared_ptr<T> openShared(const std::string &directory, Args &&...args)
+{
+  static std::mutex mutex;
+  static std::unordered_map<std::string, std::weak_ptr<T>> instances;
+
+  std::lock_guard lock(mutex);
+  auto &entry = instances[directory];
+  auto instance = entry.lock();
+  if (!instance)
+  {
+    instance = std::make_shared<T>(directory, std::forward<Args>(args)...);
+    entry = instance;
+  }
+  return instance;
+}
+
+/**
+ * @brief lockFile
+ * @details flock(), retried when interrupted by a signal
+ */
+bool lockFile(int fd, int operation);
+
+/**
+ * @brief sharedTmpPath
+ * @return hidden name next to path, unique per process and call:
+ * <dir>/.<name>.<pid>.<counter>.tmp
+ */
+std::string sharedTmpPath(const std::string &path);
+
+/**
+ * @brief publishFile
+ * @details renames tmpPath to path, replacing an existing file atomically;
+ * tmpPath is removed on failure
+ */
+bool publishFile(const std::string &tmpPath, const std::string &path, std::string &error);
+
+/**
+ * @brief writeShared
+ * @details writes data to a sharedTmpPath(), syncs it and publishes it as path
+ */
+bool writeShared(const std::string &path, std::string_view data, std::string &error);
+
+/**
+ * @brief createDirectoriesShared
+ * @details like std::filesystem::create_directories(), a directory created by
+ * another process in the meantime is success
+ */
+bool createDirectoriesShared(const std::string &path, std::string &error);
+
+/**
+ * @brief lockOutput
+ * @details opens the existing file read/write and locks it exclusively (flock); if the
+ * file was replaced while waiting, the lock is taken again on the new one
+ * @return file descriptor, the lock is released by closing it; -1 on error
+ */
+int lockOutput(const std::string &path, std::string &error);
@@ -0,0 +1,172 @@
+/**
+ * @file rz_stream_encoder.hpp
+ * @author ZHENG Robert (robert.hase-zheng.net)
+ * @brief chunked streaming encoder for JSON, BSON, CBOR, MessagePack, UBJSON and BJData
+ * @version 0.1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2025 ZHENG Robert
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+/**
+ * @brief supported output formats
+ */
+enum class OutputFormat
+{
+  JSON,
+  BSON,
+  CBOR,
+  MSGPACK,
+  UBJSON,
+  BJDATA
+};
+
+/**
+ * @brief Rz_text
+ * @details non-owning view on UTF-8 or UTF-16 (QString) text
+ */
+using Rz_text = std::variant<std::string_view, std::u16string_view>;
+
+/**
+ * @brief The Rz_byteSink class
+ * @details destination of the encoded bytes (file, memory, ...)
+ */
+class Rz_byteSink
+{
+public:
+  virtual ~Rz_byteSink() = default;
+
+  /**
+   * @brief write
+   * @return false if the bytes could not be written
+   */
+  virtual bool write(const char *data, std::size_t size) = 0;
+};
+
+/**
+ * @brief The Rz_bufferSink class
+ * @details collects the encoded bytes in memory
+ */
+class Rz_bufferSink : public Rz_byteSink
+{
+public:
+  std::string data;
+
+  bool write(const char *bytes, std::size_t size) override
+  {
+    data.append(bytes, size);
+    return true;
+  }
+};
+
+/**
+ * @brief The Rz_streamEncoder class
+ * @details encodes a record without building a DOM or a complete output buffer.
+ * Text is transcoded and written in chunks of at most chunkSize bytes, so the memory
+ * used per record is bounded by the fixed buffers of the encoder.
+ * The byte layout is the same as nlohmann::json::dump() / to_cbor() / to_msgpack() /
+ * to_ubjson() / to_bjdata() / to_bson() of the equivalent object, except CBOR text
+ * larger than chunkSize, which is written as an indefinite-length string.
+ */
+class Rz_streamEncoder
+{
+public:
+  static constexpr std::size_t chunkSize{64 * 1024};
+
+  /**
+   * @brief The Node struct
+   * @details key/value pair; with children != nullptr the value is an object
+   * (value is ignored). Children have to be ordered with less().
+   */
+  struct Node
+  {
+    Rz_text key{std::string_view{}};
+    Rz_text value{std::string_view{}};
+    const std::vector<Node> *children{nullptr};
+  };
+
+  Rz_streamEncoder(OutputFormat fmt, Rz_byteSink &sink);
+  ~Rz_streamEncoder() = default;
+
+  /**
+   * @brief encode
+   * @param root <ordered top-level members>
+   * @return false if the sink failed or a size limit of the format is exceeded
+   */
+  bool encode(const std::vector<Node> &root);
+
+  /**
+   * @brief write
+   * @details raw bytes behind the record (e.g. JSON newline)
+   */
+  bool write(const char *data, std::size_t size);
+
+  /**
+   * @brief flush
+   * @details pass buffered bytes to the sink
+   */
+  bool flush();
+
+  /**
+   * @brief less
+   * @details key order of nlohmann::json objects (UTF-8 byte order)
+   */
+  static bool less(const Rz_text &lhs, const Rz_text &rhs);
+
+  /**
+   * @brief utf8Size
+   * @return number of bytes of the text encoded as UTF-8
+   */
+  static std::size_t utf8Size(const Rz_text &text);
+
+  /**
+   * @brief appendUtf8
+   * @details append the text encoded as UTF-8, without temporary copies
+   */
+  static void appendUtf8(std::string &out, const Rz_text &text);
+
+private:
+  OutputFormat format;
+  Rz_byteSink &sink;
+  bool ok{true};
+
+  std::unique_ptr<char[]> buffer;
+  std::size_t used{0};
+  std::unique_ptr<char[]> scratch;
+
+  void put(const char *data, std::size_t size);
+  void put(char c);
+  void putBigEndian(std::uint64_t value, int bytes);
+  void putLittleEndian(std::uint64_t value, int bytes);
+
+  template <typename Fn>
+  void forEachChunk(const Rz_text &text, Fn &&fn);
+
+  void writeJson(const std::vector<Node> &nodes);
+  void writeJsonText(const Rz_text &text);
+
+  void writeCborHeader(std::uint8_t major, std::uint64_t value);
+  void writeCbor(const std::vector<Node> &nodes);
+  void writeCborText(const Rz_text &text);
+
+  void writeMsgpack(const std::vector<Node> &nodes);
+  void writeMsgpackText(const Rz_text &text);
+
+  void writeUbjsonSize(std::uint64_t value);
+  void writeUbjson(const std::vector<Node> &nodes);
+
+  std::uint64_t bsonSize(const std::vector<Node> &nodes);
+  void writeBson(const std::vector<Node> &nodes);
+  void writeBsonCString(const Rz_text &text);
+};
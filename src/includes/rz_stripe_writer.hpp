@@ -0,0 +1,95 @@
+/**
+ * @file rz_stripe_writer.hpp
+ * @author ZHENG Robert (robert.hase-zheng.net)
+ * @brief output striped over several roots, one writer queue per root
+ * @version 0.1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2025 ZHENG Robert
+ *
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief The Rz_stripeWriter class
+ * @details writes the files of one output root on its own thread, so the roots (devices)
+ * work in parallel. One instance per root and process, shared by all writer contexts;
+ * each context queues its files with a Batch of its own and sees only their results.
+ */
+class Rz_stripeWriter
+{
+public:
+  static constexpr std::size_t maxPendingBytes{64 * 1024 * 1024};
+
+  // files queued by one context, updated by the writer thread
+  struct Batch
+  {
+    std::uint64_t pending{0};
+    std::vector<std::string> failed; // file names
+    std::string lastError;
+  };
+
+  static std::shared_ptr<Rz_stripeWriter> open(const std::string &root);
+
+  /**
+   * @brief stripeOf
+   * @details stable root of a record: FNV-1a hash of the file basename modulo the number
+   * of roots, the same on every host and run as long as the list of roots is unchanged
+   */
+  static std::size_t stripeOf(std::string_view fileBasename, std::size_t stripes);
+
+  explicit Rz_stripeWriter(std::string root);
+  ~Rz_stripeWriter();
+
+  Rz_stripeWriter(const Rz_stripeWriter &) = delete;
+  Rz_stripeWriter &operator=(const Rz_stripeWriter &) = delete;
+
+  const std::string &path() const { return root; }
+
+  /**
+   * @brief enqueue
+   * @details queue the file for writing, blocks while more than maxPendingBytes are queued
+   * @param shared other processes write into the root too: written under a name of its
+   * own and renamed into place, see writeShared()
+   */
+  void enqueue(std::string fileName, std::string data, const std::shared_ptr<Batch> &batch, bool shared = false);
+
+  /**
+   * @brief drain
+   * @details wait until the files of the batch are written and take their results
+   * @param failed names of the files not written since the last drain()
+   * @return false and the last error if writes of the batch failed
+   */
+  bool drain(Batch &batch, std::vector<std::string> &failed, std::string &error);
+
+private:
+  struct Job
+  {
+    std::string fileName;
+    std::string data;
+    bool shared;
+    std::shared_ptr<Batch> batch;
+  };
+
+  std::string root;
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::deque<Job> jobs;
+  std::size_t pendingBytes{0};
+  bool stopping{false};
+  std::thread worker;
+
+  void run();
+};
@@ -0,0 +1,61 @@
+/**
+ * @file rz_test.hpp
+ * @author ZHENG Robert (robert.hase-zheng.net)
+ * @brief checks and scratch directory of the regression tests
+ * @version 0.1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2025 ZHENG Robert
+ *
+ */
+
+#pragma once
+
+#include <unistd.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief The Rz_testRun class
+ * @details one run of a test program: every check is printed, failed ones are counted.
+ * The scratch directory <tmp>/<name>.<pid> is created with the run and removed by
+ * result().
+ */
+class Rz_testRun
+{
+public:
+  explicit Rz_testRun(std::string_view name)
+      : dir(std::filesystem::temp_directory_path() / std::format("{}.{}", name, ::getpid()))
+  {
+    std::filesystem::create_directories(dir);
+  }
+
+  const std::filesystem::path &directory() const { return dir; }
+
+  void check(bool ok, const std::string &what)
+  {
+    std::cout << std::format("{} {}\n", ok ? "ok    " : "FAILED", what);
+    failures += ok ? 0 : 1;
+  }
+
+  /**
+   * @brief result
+   * @return exit code of the test program, EXIT_FAILURE if a check failed
+   */
+  int result()
+  {
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+    std::cout << std::format("{} failures\n", failures);
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+private:
+  std::filesystem::path dir;
+  int failures{0};
+};
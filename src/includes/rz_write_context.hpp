@@ -0,0 +1,248 @@
+/**
+ * @file rz_write_context.hpp
+ * @author ZHENG Robert (robert.hase-zheng.net)
+ * @brief independent writer context of the rz_write_json plugin
+ * @version 0.1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2025 ZHENG Robert
+ *
+ */
+
+#pragma once
+
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMap>
+#include <QRegularExpression>
+
+#include <array>
+#include <functional>
+#include <memory>
+#include <string_view>
+
+#include "rz_archive.hpp"
+#include "rz_blob_store.hpp"
+#include "rz_change_log.hpp"
+#include "rz_checkpoint.hpp"
+#include "rz_meta_record.hpp"
+#include "rz_photo-gallery_plugins.hpp"
+#include "rz_record_scanner.hpp"
+#include "rz_search_index.hpp"
+#include "rz_stream_encoder.hpp"
+#include "rz_stripe_writer.hpp"
+
+/**
+ * @brief The Rz_writeShared struct
+ * @details immutable tables shared by all writer contexts
+ */
+struct Rz_writeShared
+{
+  // names and extensions of the output formats: outputFormatFromName() and
+  // outputFormatExtension() of rz_record_codec.hpp
+
+  // section names of setQHash()/getQHash() and keys of the top-level object,
+  // indexed by Rz_section
+  static constexpr std::array<std::string_view, Rz_metaRecord::sectionCount> sectionKeys{
+      "PICTURE", "EXIF", "IPTC", "XMP"};
+
+  /**
+   * @brief instance
+   * @details created once per process, read-only afterwards
+   */
+  static std::shared_ptr<const Rz_writeShared> instance();
+};
+
+/**
+ * @brief The Rz_writeContext class
+ * @details writing image Metadata of one record sequence; not thread-safe, every
+ * thread owns its own context (see createContext())
+ */
+class Rz_writeContext : public Plugin
+{
+public:
+  explicit Rz_writeContext(std::shared_ptr<const Rz_writeShared> shared = Rz_writeShared::instance());
+  ~Rz_writeContext() = default;
+
+private:
+  std::shared_ptr<const Rz_writeShared> shared;
+
+  bool oknok{false};
+  std::string msg{"blank"};
+  QString debugMsg{QStringLiteral("blank")};
+
+  QString outputExtension{QStringLiteral(".json")};
+  int outputFormatFlag{0};
+
+  std::optional<OutputFormat> enumFromString(const QString &type);
+  QString extensionFromEnum(OutputFormat fmt);
+
+  struct imageStruct
+  {
+    QString fileName{""};        // 2014-04-18_203353.jpg
+    QString fileBasename{""};    // 2014-04-18_203353
+    QString fileSuffix{""};      // jpg
+    QString fileAbolutePath{""}; // /home/zb_bamboo/pictures/images
+    QString homePath{""};        // /home/zb_bamboo
+  };
+  imageStruct imgStruct;
+  void setImgStruct(const imageStruct &imgStructData);
+
+  QMap<QString, QString> qMap;
+
+  // PICTURE, EXIF, IPTC and XMP data of the current record; the first setQHash()
+  // after writeFile() starts the next record in the same buffers
+  Rz_metaRecord record;
+  bool recordWritten{false};
+  std::optional<Rz_section> sectionFromType(const QString &type) const;
+
+  // update mode: writeFile() replaces only the sections set since the last
+  // writeFile() in the existing output, ":merge" sections only their keys
+  bool updateMode{false};
+  std::array<bool, Rz_metaRecord::sectionCount> mergeKeys{};
+  std::tuple<bool, std::string> updateFile(const QString &binFile, OutputFormat format);
+
+  // shared output tree: other processes write into the same folders, see setQstring("shared")
+  bool sharedMode{false};
+
+  // search index in the output directory, see setQstring("index") and setQList("indexFields")
+  struct IndexField
+  {
+    std::string name; // XMP.keywords
+    Rz_section section;
+    std::string key;
+  };
+  bool indexEnabled{false};
+  std::vector<IndexField> indexFields;
+  QString indexDir;
+  std::shared_ptr<Rz_searchIndex> searchIndex;
+  bool setIndexFields(const QList<QString> &fields);
+  std::tuple<bool, std::string> indexRecord(const QString &pathToBinDir, const QString &binFile);
+  QList<QString> search(const QString &query);
+
+  // append-only archive instead of one file per image, see setQstring("archive")
+  static constexpr double defaultCompactRate{32.0}; // MB/s
+  bool archiveEnabled{false};
+  bool directIo{false}; // archive past the page cache, see setQstring("direct")
+  QString archiveDir;
+  std::shared_ptr<Rz_archive> archive;
+  bool openArchive();
+  std::tuple<bool, std::string> appendToArchive(const QString &pathToBinDir, OutputFormat format);
+
+  // content-addressed sections and per-image manifests, see setQstring("dedup")
+  bool dedupEnabled{false};
+  QString dedupDir;
+  std::shared_ptr<Rz_blobStore> blobStore;
+  std::tuple<bool, std::string> writeDeduplicated(const QString &pathToBinDir,
+                                                  const QString &binFile,
+                                                  OutputFormat format);
+
+  // change feed of the output folder, see setQstring("changes")
+  bool changeFeed{false};
+  std::shared_ptr<Rz_changeLog> changeLog;
+  nlohmann::json exportedRecord(const QString &binFile, OutputFormat format) const;
+  nlohmann::json recordJson() const;
+  bool logChange(const QString &pathToBinDir, const std::string &name, nlohmann::json before, nlohmann::json after);
+  // delta of a queued striped write, logged once the file is written
+  struct QueuedChange
+  {
+    std::string fileName;
+    std::string record;
+    nlohmann::json before;
+    nlohmann::json after;
+  };
+  std::vector<std::vector<QueuedChange>> changesQueued; // per stripe, until written
+
+  // checkpoint journal per output folder, see setQstring("checkpoint")
+  bool checkpointEnabled{false};
+  QHash<QString, std::shared_ptr<Rz_checkpoint>> checkpoints;
+  std::vector<std::vector<std::string>> checkpointQueued; // per stripe, until written
+  std::shared_ptr<Rz_checkpoint> checkpointOf(const QString &pathToBinDir);
+  bool flushCheckpoints();
+  std::tuple<bool, std::string> writeRecord(const QString &targetDir, bool striped, std::size_t stripe);
+
+  // striped output over several roots, see setQList("stripeRoots")
+  QList<QString> stripeRoots;
+  std::vector<std::shared_ptr<Rz_stripeWriter>> stripeWriters;
+  std::vector<std::shared_ptr<Rz_stripeWriter::Batch>> stripeBatches; // files queued by this context
+  std::tuple<bool, std::string> enqueueStriped(std::size_t stripe, OutputFormat format);
+  std::string stripeErrors; // of stripes drained before an update, see drainStripes()
+  std::string drainStripe(std::size_t stripe);
+  std::tuple<bool, std::string> drainStripes();
+
+  static constexpr double defaultCacheSize{64.0}; // MB, see setQstring("cache")
+
+  // parsed record file, kept mapped in lazy mode until the next parseFile(),
+  // setQHash() or doClose()
+  using Visitor = std::function<void(std::string_view key, std::string_view value)>;
+  bool lazyMode{false};
+  QFile parsedFile;
+  uchar *parsedData{nullptr};
+  OutputFormat parsedFormat{OutputFormat::JSON};
+  std::vector<Rz_scanEntry> parsedEntries;
+  std::array<std::string, Rz_metaRecord::sectionCount> parsedBlobs; // sections of a dedup manifest
+  void closeParsed();
+  std::string_view parsedBytes() const;
+  std::optional<std::string_view> parsedSection(Rz_section section) const;
+  void decodeParsed(Rz_section section, const Visitor &visit) const;
+  QString parsedValue(const QString &keyPath) const;
+
+  std::tuple<bool, std::string> isTargetExist(const QFile &pathToTarget,
+                                              const QString &type);
+  std::tuple<bool, std::string> createDirectories(const std::filesystem::path &p);
+
+public:
+  QString getPluginNameShort() Q_DECL_OVERRIDE;
+  QString getPluginNameLong() Q_DECL_OVERRIDE;
+  QString getPluginVersion() Q_DECL_OVERRIDE;
+  QString getPluginDescription() Q_DECL_OVERRIDE;
+  int32_t getPluginMajorVersion() Q_DECL_OVERRIDE;
+  int32_t getPluginMinorVersion() Q_DECL_OVERRIDE;
+  int32_t getPluginPatchVersion() Q_DECL_OVERRIDE;
+  QString getPluginHomepageUrl() Q_DECL_OVERRIDE;
+  QString getPluginCopyright() Q_DECL_OVERRIDE;
+  QString getPluginTechInfo() Q_DECL_OVERRIDE;
+
+  /**
+   * @brief parseFile
+   * @param type <path to an exported record>
+   * @details reads the record into the PICTURE, EXIF, IPTC and XMP sections; in lazy
+   * mode the file stays mapped and getQHash()/getQstring("key:...") decode only the
+   * requested section or key
+   */
+  std::tuple<bool, std::string> parseFile(const QString &type = "") Q_DECL_OVERRIDE;
+
+  /**
+   * @brief writeFile
+   * @param type <path to flatbuffers folder>
+   * @return <bool, msg string>
+   */
+  std::tuple<bool, std::string> writeFile(const QString &type = "") Q_DECL_OVERRIDE;
+
+  std::tuple<bool, std::string> doRun(const QString &type = "") Q_DECL_OVERRIDE;
+  std::tuple<bool, std::string> doClose(const QString &type = "") Q_DECL_OVERRIDE;
+
+  /**
+   * @brief createContext
+   * @details new context sharing the immutable tables, starts without record data
+   * and with JSON output format
+   */
+  std::shared_ptr<Plugin> createContext() Q_DECL_OVERRIDE;
+
+  std::tuple<bool, std::string> setQstring(const QString &string,
+                                           const QString &type = "") Q_DECL_OVERRIDE;
+  QString getQstring(const QString &type = "") Q_DECL_OVERRIDE;
+
+  std::tuple<bool, std::string> setQList(const QList<QString> &stringList,
+                                         const QString &type = "") Q_DECL_OVERRIDE;
+  QList<QString> getQList(const QString &type = "") Q_DECL_OVERRIDE;
+
+  std::tuple<bool, std::string> setQMap(const QMap<QString, QString> &setQmap,
+                                        const QString &type = "") Q_DECL_OVERRIDE;
+  QMap<QString, QString> getQMap(const QString &type = "") Q_DECL_OVERRIDE;
+
+  std::tuple<bool, std::string> setQHash(const QHash<QString, QString> &setQhash,
+                                         const QString &type = "") Q_DECL_OVERRIDE;
+  QHash<QString, QString> getQHash(const QString &type = "") Q_DECL_OVERRIDE;
+};
@@ -2,8 +2,8 @@
  * @file rz_write_json.hpp
  * @author ZHENG Robert (robert.hase-zheng.net)
  * @brief write image metadata into JSON format
- * @version 0.1.0
- * @date 2025-11-29
+ * @version 0.2.0
+ * @date 2026-10-19
  *
  * @copyright Copyright (c) 2025 ZHENG Robert
  *
@@ -11,139 +11,23 @@
 
 #pragma once
 
-#include <QFile>
-#include <QFileInfo>
-#include <QHash>
-#include <QMap>
 #include <QObject>
-#include <QRegularExpression>
 #include <QtPlugin>
 
-#include "rz_photo-gallery_plugins.hpp"
+#include "rz_write_context.hpp"
 
 /**
  * @brief The Rz_writeJson class
- * @details writing image Metadata to JSON file
+ * @details writing image Metadata to JSON file; the plugin instance is the default
+ * writer context, multithreaded hosts create one context per thread with createContext()
  */
-class Rz_writeJson : public QObject, public Plugin
+class Rz_writeJson : public QObject, public Rz_writeContext
 {
   Q_OBJECT
-  Q_PLUGIN_METADATA(IID "net.hase-zheng.photo_gallery_plugins");
+  Q_PLUGIN_METADATA(IID Plugin_iid);
   Q_INTERFACES(Plugin);
 
 public:
   explicit Rz_writeJson(QObject *parent = nullptr);
   ~Rz_writeJson() = default;
-
-private:
-  bool oknok{false};
-  std::string msg{"blank"};
-  QString debugMsg{"blank"};
-
-  QString outputExtension{".json"};
-  int outputFormatFlag{0};
-
-  // Output format flags
-  enum class OutputFormat
-  {
-    JSON,
-    BSON,
-    CBOR,
-    MSGPACK,
-    UBJSON,
-    BJDATA
-  };
-  struct OutputFormatInfo
-  {
-    QHash<OutputFormat, QString> extensions{
-        {OutputFormat::JSON, ".json"},
-        {OutputFormat::BSON, ".bson"},
-        {OutputFormat::CBOR, ".cbor"},
-        {OutputFormat::MSGPACK, ".msgpack"},
-        {OutputFormat::UBJSON, ".ubjson"},
-        {OutputFormat::BJDATA, ".bjdata"}};
-
-    QString extension(OutputFormat fmt) const
-    {
-      return extensions.value(fmt);
-    }
-  };
-  OutputFormatInfo outputFormats;
-  std::optional<OutputFormat> formatFromExtension(const QString &ext);
-
-  const QHash<QString, OutputFormat> stringToOutputFormat{
-      {"JSON", OutputFormat::JSON},
-      {"BSON", OutputFormat::BSON},
-      {"CBOR", OutputFormat::CBOR},
-      {"MSGPACK", OutputFormat::MSGPACK},
-      {"UBJSON", OutputFormat::UBJSON},
-      {"BJDATA", OutputFormat::BJDATA}};
-  std::optional<OutputFormat> enumFromString(const QString &type);
-  QString extensionFromEnum(OutputFormat fmt);
-
-  struct imageStruct
-  {
-    QString fileName{""};        // 2014-04-18_203353.jpg
-    QString fileBasename{""};    // 2014-04-18_203353
-    QString fileSuffix{""};      // jpg
-    QString fileAbolutePath{""}; // /home/zb_bamboo/pictures/images
-    QString homePath{""};        // /home/zb_bamboo
-  };
-  imageStruct imgStruct;
-  void setImgStruct(const imageStruct &imgStructData);
-
-  QMap<QString, QString> qMap;
-
-  QHash<QString, QString> pictureData;
-  QHash<QString, QString> exifData;
-  QHash<QString, QString> iptcData;
-  QHash<QString, QString> xmpData;
-
-  std::tuple<bool, std::string> isTargetExist(const QFile &pathToTarget,
-                                              const QString &type);
-  std::tuple<bool, std::string> createDirectories(const std::filesystem::path &p);
-
-public:
-  QString getPluginNameShort() Q_DECL_OVERRIDE;
-  QString getPluginNameLong() Q_DECL_OVERRIDE;
-  QString getPluginVersion() Q_DECL_OVERRIDE;
-  QString getPluginDescription() Q_DECL_OVERRIDE;
-  int32_t getPluginMajorVersion() Q_DECL_OVERRIDE;
-  int32_t getPluginMinorVersion() Q_DECL_OVERRIDE;
-  int32_t getPluginPatchVersion() Q_DECL_OVERRIDE;
-  QString getPluginHomepageUrl() Q_DECL_OVERRIDE;
-  QString getPluginCopyright() Q_DECL_OVERRIDE;
-  QString getPluginTechInfo() Q_DECL_OVERRIDE;
-
-  /**
-   * @brief parseFile
-   * @details not in use
-   */
-  std::tuple<bool, std::string> parseFile(const QString &type = "") Q_DECL_OVERRIDE;
-
-  /**
-   * @brief writeFile
-   * @param type <path to flatbuffers folder>
-   * @return <bool, msg string>
-   */
-  std::tuple<bool, std::string> writeFile(const QString &type = "") Q_DECL_OVERRIDE;
-
-  std::tuple<bool, std::string> doRun(const QString &type = "") Q_DECL_OVERRIDE;
-  std::tuple<bool, std::string> doClose(const QString &type = "") Q_DECL_OVERRIDE;
-
-  std::tuple<bool, std::string> setQstring(const QString &string,
-                                           const QString &type = "") Q_DECL_OVERRIDE;
-  QString getQstring(const QString &type = "") Q_DECL_OVERRIDE;
-
-  std::tuple<bool, std::string> setQList(const QList<QString> &stringList,
-                                         const QString &type = "") Q_DECL_OVERRIDE;
-  QList<QString> getQList(const QString &type = "") Q_DECL_OVERRIDE;
-
-  std::tuple<bool, std::string> setQMap(const QMap<QString, QString> &setQmap,
-                                        const QString &type = "") Q_DECL_OVERRIDE;
-  QMap<QString, QString> getQMap(const QString &type = "") Q_DECL_OVERRIDE;
-
-  std::tuple<bool, std::string> setQHash(const QHash<QString, QString> &setQhash,
-                                         const QString &type = "") Q_DECL_OVERRIDE;
-  QHash<QString, QString> getQHash(const QString &type = "") Q_DECL_OVERRIDE;
 };
@@ -0,0 +1,794 @@
+/**
+ * @file rz_archive.cpp
+ * @author ZHENG Robert (robert.hase-zheng.net)
+ * @brief append-only archive of encoded records with background compaction
+ * @version 0.1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2025 ZHENG Robert
+ *
+ */
+
+#include "includes/rz_archive.hpp"
+#include "includes/rz_direct_writer.hpp"
+#include "includes/rz_shared_output.hpp"
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <map>
+#include <utility>
+
+namespace
+{
+constexpr std::size_t frameHeaderSize{8}; // size, type, format, key size
+constexpr std::size_t crcSize{4};
+
+constexpr std::array<std::uint32_t, 256> crcTable = [] {
+    std::array<std::uint32_t, 256> table{};
+    for (std::uint32_t i = 0; i < 256; ++i)
+    {
+        std::uint32_t c = i;
+        for (int k = 0; k < 8; ++k)
+        {
+            c = (c & 1) != 0 ? 0xEDB88320U ^ (c >> 1) : c >> 1;
+        }
+        table[i] = c;
+    }
+    return table;
+}();
+
+std::uint32_t crc32(std::string_view data)
+{
+    std::uint32_t crc = 0xFFFFFFFFU;
+    for (const char c : data)
+    {
+        crc = crcTable[(crc ^ static_cast<unsigned char>(c)) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFU;
+}
+
+std::uint32_t readLe(const char *p, int bytes)
+{
+    std::uint32_t value = 0;
+    for (int i = 0; i < bytes; ++i)
+    {
+        value |= static_cast<std::uint32_t>(static_cast<unsigned char>(p[i])) << (8 * i);
+    }
+    return value;
+}
+
+void appendLe(std::string &out, std::uint32_t value, int bytes)
+{
+    for (int i = 0; i < bytes; ++i)
+    {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+bool writeAll(int fd, const char *data, std::size_t size)
+{
+    while (size > 0)
+    {
+        const ssize_t n = ::write(fd, data, size);
+        if (n <= 0)
+        {
+            return false;
+        }
+        data += n;
+        size -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+/**
+ * @brief The Mapping class
+ * @details read-only mapping of a segment, empty if missing
+ */
+class Mapping
+{
+public:
+    explicit Mapping(const std::string &path)
+    {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat st{};
+        if (fd >= 0 && fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            void *mapped = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+            if (mapped != MAP_FAILED)
+            {
+                data = static_cast<const char *>(mapped);
+                size = static_cast<std::size_t>(st.st_size);
+                madvise(mapped, size, MADV_SEQUENTIAL);
+            }
+        }
+        if (fd >= 0)
+        {
+            ::close(fd);
+        }
+    }
+    ~Mapping()
+    {
+        if (data != nullptr)
+        {
+            munmap(const_cast<char *>(data), size);
+        }
+    }
+    Mapping(Mapping &&other) noexcept
+        : data(std::exchange(other.data, nullptr))
+        , size(std::exchange(other.size, 0))
+    {}
+    Mapping(const Mapping &) = delete;
+    Mapping &operator=(const Mapping &) = delete;
+    Mapping &operator=(Mapping &&) = delete;
+
+    std::string_view view() const { return std::string_view(data, size); }
+
+private:
+    const char *data{nullptr};
+    std::size_t size{0};
+};
+
+/**
+ * @brief scanSegment
+ * @details visits the valid frames of a segment; a torn frame ends it, unless resync is
+ * set: in a shared archive frames of other processes may follow a torn one, the scan
+ * then continues at the next offset that holds a frame with a valid CRC
+ */
+void scanSegment(std::string_view data,
+                 const std::function<void(const Rz_archiveFrame &)> &visit,
+                 bool resync = false)
+{
+    std::size_t pos = 0;
+    while (data.size() - pos >= frameHeaderSize + crcSize)
+    {
+        const std::uint32_t size = readLe(data.data() + pos, 4);
+        const bool sized = size >= frameHeaderSize - 4 + crcSize && size <= data.size() - pos - 4;
+        const std::string_view frame = sized ? data.substr(pos, 4 + size) : std::string_view();
+        const std::uint32_t keySize = sized ? readLe(frame.data() + 6, 2) : 0;
+        if (!sized || static_cast<std::uint8_t>(frame[4]) > Rz_archiveFrame::Tombstone
+            || static_cast<std::uint8_t>(frame[5]) > static_cast<std::uint8_t>(OutputFormat::BJDATA)
+            || frameHeaderSize + keySize + crcSize > frame.size()
+            || crc32(frame.substr(4, frame.size() - 4 - crcSize))
+                   != readLe(frame.data() + frame.size() - crcSize, 4))
+        {
+            if (!resync)
+            {
+                return;
+            }
+            ++pos;
+            continue;
+        }
+        const auto format = static_cast<std::uint8_t>(frame[5]);
+
+        Rz_archiveFrame f;
+        f.type = static_cast<Rz_archiveFrame::Type>(frame[4]);
+        f.format = static_cast<OutputFormat>(format);
+        f.key = frame.substr(frameHeaderSize, keySize);
+        f.payload = frame.substr(frameHeaderSize + keySize, frame.size() - frameHeaderSize - keySize - crcSize);
+        f.bytes = frame;
+        visit(f);
+        pos += frame.size();
+    }
+}
+
+/**
+ * @brief readManifest
+ * @details manifest: "RZA 1 <next segment number>", then one segment per line
+ */
+bool readManifest(const std::string &path, std::uint32_t &next, std::vector<std::string> &list)
+{
+    std::ifstream manifest(path);
+    std::string magic;
+    int version = 0;
+    std::uint32_t number = 0;
+    if (!(manifest >> magic >> version >> number) || magic != "RZA" || version != 1)
+    {
+        return false;
+    }
+    next = number;
+    list.clear();
+    std::string segment;
+    while (manifest >> segment)
+    {
+        list.push_back(segment);
+    }
+    return true;
+}
+
+/**
+ * @brief The ManifestLock class
+ * @details exclusive lock of the archive lock file, serializes manifest changes
+ * between processes; within the process the archive mutex does
+ */
+class ManifestLock
+{
+public:
+    explicit ManifestLock(int fd)
+        : fd(fd)
+        , locked(fd >= 0 && lockFile(fd, LOCK_EX))
+    {}
+    ~ManifestLock()
+    {
+        if (locked)
+        {
+            lockFile(fd, LOCK_UN);
+        }
+    }
+    ManifestLock(const ManifestLock &) = delete;
+    ManifestLock &operator=(const ManifestLock &) = delete;
+
+    explicit operator bool() const { return locked; }
+
+private:
+    int fd;
+    bool locked;
+};
+
+} // namespace
+
+std::shared_ptr<Rz_archive> Rz_archive::open(const std::string &directory, bool shared)
+{
+    auto archive = openShared<Rz_archive>(directory, shared);
+    if (shared)
+    {
+        archive->shared = true;
+    }
+    return archive;
+}
+
+Rz_archive::Rz_archive(std::string dir, bool shared)
+    : directory(std::move(dir))
+    , shared(shared)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+
+    std::lock_guard lock(mutex);
+    lockFd = ::open((directory + "/" + std::string(lockName)).c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    const ManifestLock manifestLock(lockFd);
+    if (!manifestLock)
+    {
+        return;
+    }
+    loadManifestLocked();
+    if (segments.empty())
+    {
+        nextSegment = std::max<std::uint32_t>(nextSegment, 1);
+        segments.push_back(newSegmentLocked());
+        if (openActiveLocked(true) && !storeManifestLocked(segments))
+        {
+            ::close(activeFd);
+            activeFd = -1;
+        }
+        return;
+    }
+    openActiveLocked(false);
+}
+
+Rz_archive::~Rz_archive()
+{
+    if (compactor.joinable())
+    {
+        compactor.join();
+    }
+    if (activeFd >= 0)
+    {
+        ::close(activeFd);
+    }
+    if (lockFd >= 0)
+    {
+        ::close(lockFd);
+    }
+}
+
+bool Rz_archive::loadManifestLocked()
+{
+    const std::string path = directory + "/" + std::string(manifestName);
+    if (::stat(path.c_str(), &manifestStat) != 0)
+    {
+        manifestStat = {};
+    }
+    return readManifest(path, nextSegment, segments);
+}
+
+/**
+ * @brief Rz_archive::manifestChangedLocked
+ * @details a new manifest is renamed into place, that changes inode and mtime
+ */
+bool Rz_archive::manifestChangedLocked() const
+{
+    struct stat st{};
+    if (::stat((directory + "/" + std::string(manifestName)).c_str(), &st) != 0)
+    {
+        return true;
+    }
+    return st.st_ino != manifestStat.st_ino || st.st_size != manifestStat.st_size
+           || st.st_mtim.tv_sec != manifestStat.st_mtim.tv_sec || st.st_mtim.tv_nsec != manifestStat.st_mtim.tv_nsec;
+}
+
+/**
+ * @brief Rz_archive::refreshLocked
+ * @details shared archive: takes over segments and active segment of a manifest
+ * written by another process
+ */
+bool Rz_archive::refreshLocked()
+{
+    if (manifestChangedLocked() && !loadManifestLocked())
+    {
+        return false;
+    }
+    if (!segments.empty() && segments.back() != activeSegment)
+    {
+        return openActiveLocked(false);
+    }
+    return activeFd >= 0;
+}
+
+std::string Rz_archive::newSegmentLocked()
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "segment-%08u.rza", nextSegment++);
+    return name;
+}
+
+/**
+ * @brief Rz_archive::allocateSegmentLocked
+ * @details segment name for the compaction; in a shared archive the number is taken
+ * from the current manifest and the manifest stored with the next one
+ */
+std::string Rz_archive::allocateSegmentLocked()
+{
+    if (!shared)
+    {
+        return newSegmentLocked();
+    }
+    const ManifestLock manifestLock(lockFd);
+    loadManifestLocked();
+    std::string name = newSegmentLocked();
+    storeManifestLocked(segments);
+    return name;
+}
+
+bool Rz_archive::openActiveLocked(bool create)
+{
+    if (activeFd >= 0)
+    {
+        ::close(activeFd);
+    }
+    activeSegment = segments.back();
+    const std::string path = directory + "/" + activeSegment;
+    activeFd = ::open(path.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC | (create ? O_TRUNC : 0), 0644);
+    activeSize = 0;
+    writebackStart = 0;
+    writebackDone = 0;
+    // cut a torn frame of an interrupted append, later frames would be unreachable;
+    // not while another process appends, its frame in flight would look torn
+    if (activeFd >= 0 && !create && lockFile(activeFd, LOCK_EX | LOCK_NB))
+    {
+        const Mapping mapping(path);
+        const char *begin = mapping.view().data();
+        scanSegment(
+            mapping.view(),
+            [this, begin](const Rz_archiveFrame &frame) {
+                activeSize = static_cast<std::uint64_t>(frame.bytes.data() + frame.bytes.size() - begin);
+            },
+            shared);
+        if (activeSize < mapping.view().size() && ftruncate(activeFd, static_cast<off_t>(activeSize)) != 0)
+        {
+            ::close(activeFd);
+            activeFd = -1;
+            return false;
+        }
+        lockFile(activeFd, LOCK_UN);
+    }
+    return activeFd >= 0;
+}
+
+bool Rz_archive::storeManifestLocked(const std::vector<std::string> &list)
+{
+    std::string content = std::format("RZA 1 {}\n", nextSegment);
+    for (const auto &segment : list)
+    {
+        content.append(segment).push_back('\n');
+    }
+
+    // write a new manifest and rename it into place, under the lock file
+    const std::string path = directory + "/" + std::string(manifestName);
+    const std::string tmpPath = path + ".tmp";
+    const int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        return false;
+    }
+    bool ok = writeAll(fd, content.data(), content.size());
+    ok = fsync(fd) == 0 && ok;
+    ok = ::close(fd) == 0 && ok;
+    if (!ok || std::rename(tmpPath.c_str(), path.c_str()) != 0)
+    {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    if (::stat(path.c_str(), &manifestStat) != 0)
+    {
+        manifestStat = {};
+    }
+    return true;
+}
+
+bool Rz_archive::rotateLocked()
+{
+    if (activeFd >= 0)
+    {
+        fsync(activeFd);
+        if (directIo)
+        {
+            Rz_directWriter::dropWritten(activeFd, 0, 0);
+        }
+    }
+    const ManifestLock manifestLock(lockFd);
+    if (!manifestLock)
+    {
+        return false;
+    }
+    if (shared)
+    {
+        // another process may have started the next segment already
+        loadManifestLocked();
+        if (!segments.empty() && segments.back() != activeSegment)
+        {
+            return openActiveLocked(false);
+        }
+    }
+    segments.push_back(newSegmentLocked());
+    return openActiveLocked(true) && storeManifestLocked(segments);
+}
+
+bool Rz_archive::appendFrame(Rz_archiveFrame::Type type,
+                             std::string_view key,
+                             OutputFormat format,
+                             std::string_view payload)
+{
+    if (key.size() > 0xFFFF)
+    {
+        return false;
+    }
+
+    std::string frame;
+    frame.reserve(frameHeaderSize + key.size() + payload.size() + crcSize);
+    appendLe(frame, static_cast<std::uint32_t>(frameHeaderSize - 4 + key.size() + payload.size() + crcSize), 4);
+    frame.push_back(static_cast<char>(type));
+    frame.push_back(static_cast<char>(format));
+    appendLe(frame, static_cast<std::uint32_t>(key.size()), 2);
+    frame.append(key);
+    frame.append(payload);
+    appendLe(frame, crc32(std::string_view(frame).substr(4)), 4);
+
+    std::lock_guard lock(mutex);
+    if (shared)
+    {
+        return appendSharedLocked(frame);
+    }
+    if (activeFd < 0 || (activeSize > 0 && activeSize + frame.size() > segmentSize && !rotateLocked()))
+    {
+        return false;
+    }
+    // one write per frame, a torn frame fails its CRC and ends the segment
+    if (!writeAll(activeFd, frame.data(), frame.size()))
+    {
+        return false;
+    }
+    activeSize += frame.size();
+    if (directIo && activeSize - writebackStart >= writeBehindBytes)
+    {
+        writeBehindLocked();
+    }
+    return true;
+}
+
+/**
+ * @brief Rz_archive::writeBehindLocked
+ * @details starts the write-back of the appends since the last call and drops the
+ * range started the time before, which is written by now
+ */
+void Rz_archive::writeBehindLocked()
+{
+    if (writebackStart > writebackDone)
+    {
+        Rz_directWriter::dropWritten(activeFd, writebackDone, writebackStart - writebackDone);
+    }
+    Rz_directWriter::startWriteback(activeFd, writebackStart, activeSize - writebackStart);
+    writebackDone = writebackStart;
+    writebackStart = activeSize;
+}
+
+/**
+ * @brief Rz_archive::appendSharedLocked
+ * @details the shared flock of the segment keeps a compaction from sealing it while the
+ * frame is in flight; the manifest is checked under it, so a frame never goes to a
+ * segment another process has sealed or replaced
+ */
+bool Rz_archive::appendSharedLocked(std::string_view frame)
+{
+    while (true)
+    {
+        if (!refreshLocked() || !lockFile(activeFd, LOCK_SH))
+        {
+            return false;
+        }
+        if (manifestChangedLocked())
+        {
+            lockFile(activeFd, LOCK_UN);
+            continue;
+        }
+        struct stat st{};
+        if (fstat(activeFd, &st) != 0)
+        {
+            lockFile(activeFd, LOCK_UN);
+            return false;
+        }
+        if (st.st_size > 0 && static_cast<std::uint64_t>(st.st_size) + frame.size() > segmentSize)
+        {
+            lockFile(activeFd, LOCK_UN);
+            if (!rotateLocked())
+            {
+                return false;
+            }
+            continue;
+        }
+        const bool ok = writeAll(activeFd, frame.data(), frame.size());
+        lockFile(activeFd, LOCK_UN);
+        return ok;
+    }
+}
+
+bool Rz_archive::append(std::string_view key, OutputFormat format, std::string_view payload)
+{
+    return appendFrame(Rz_archiveFrame::Record, key, format, payload);
+}
+
+bool Rz_archive::remove(std::string_view key)
+{
+    return appendFrame(Rz_archiveFrame::Tombstone, key, OutputFormat::JSON, {});
+}
+
+bool Rz_archive::scan(const std::function<void(const Rz_archiveFrame &)> &visit) const
+{
+    std::vector<std::string> list;
+    {
+        std::lock_guard lock(mutex);
+        list = segments;
+        std::uint32_t next = 0;
+        if (shared && manifestChangedLocked() && !readManifest(directory + "/" + std::string(manifestName), next, list))
+        {
+            return false;
+        }
+    }
+    for (const auto &segment : list)
+    {
+        const Mapping mapping(directory + "/" + segment);
+        scanSegment(mapping.view(), visit, shared);
+    }
+    return true;
+}
+
+bool Rz_archive::startCompaction(std::uint64_t bytesPerSecond)
+{
+    std::lock_guard lock(mutex);
+    if (running || activeFd < 0)
+    {
+        return false;
+    }
+    if (compactor.joinable())
+    {
+        compactor.join();
+    }
+
+    // one compaction per archive, also between processes
+    compactFd = ::open((directory + "/" + std::string(compactLockName)).c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (compactFd < 0 || !lockFile(compactFd, LOCK_EX | LOCK_NB))
+    {
+        if (compactFd >= 0)
+        {
+            ::close(compactFd);
+            compactFd = -1;
+        }
+        return false;
+    }
+
+    // everything up to now is sealed, appends go to a new segment
+    if (shared && !refreshLocked())
+    {
+        ::close(compactFd);
+        compactFd = -1;
+        return false;
+    }
+    std::vector<std::string> sealed = segments;
+    if (!rotateLocked())
+    {
+        ::close(compactFd);
+        compactFd = -1;
+        return false;
+    }
+    running = true;
+    compactor = std::thread(&Rz_archive::compact, this, std::move(sealed), bytesPerSecond);
+    return true;
+}
+
+std::string Rz_archive::report() const
+{
+    std::lock_guard lock(mutex);
+    return lastReport;
+}
+
+void Rz_archive::compact(std::vector<std::string> sealed, std::uint64_t bytesPerSecond)
+{
+    using Clock = std::chrono::steady_clock;
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+    const auto start = Clock::now();
+
+    // appends of other processes still in flight to the sealed segment end before its scan
+    if (shared && !sealed.empty())
+    {
+        const int fd = ::open((directory + "/" + sealed.back()).c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd >= 0)
+        {
+            lockFile(fd, LOCK_EX);
+            ::close(fd);
+        }
+    }
+
+    // what a reader of the archive pays: scan() of all live segments, timed the same way
+    // before and after
+    const auto timeScan = [this] {
+        const auto scanStart = Clock::now();
+        scan([](const Rz_archiveFrame &) {});
+        return Milliseconds(Clock::now() - scanStart);
+    };
+    const Milliseconds scanBefore = timeScan();
+
+    // latest frame of every key, views into the mappings
+    std::vector<Mapping> mappings;
+    mappings.reserve(sealed.size());
+    std::map<std::string_view, Rz_archiveFrame> latest;
+    std::uint64_t bytesBefore = 0;
+    std::uint64_t frames = 0;
+    for (const auto &segment : sealed)
+    {
+        mappings.emplace_back(directory + "/" + segment);
+        bytesBefore += mappings.back().view().size();
+        scanSegment(
+            mappings.back().view(),
+            [&](const Rz_archiveFrame &frame) {
+                latest[frame.key] = frame;
+                ++frames;
+            },
+            shared);
+    }
+
+    // live records in key order, tombstones are dropped: the sealed segments
+    // hold the complete history up to now
+    std::vector<std::string> written;
+    std::uint64_t bytesAfter = 0;
+    std::uint64_t records = 0;
+    std::uint64_t segmentBytes = 0;
+    Rz_directWriter out;
+    bool ok = true;
+    const auto writeStart = Clock::now();
+    for (const auto &[key, frame] : latest)
+    {
+        if (frame.type != Rz_archiveFrame::Record)
+        {
+            continue;
+        }
+        if (!out.isOpen() || (segmentBytes > 0 && segmentBytes + frame.bytes.size() > segmentSize))
+        {
+            ok = out.close() && ok;
+            {
+                std::lock_guard lock(mutex);
+                written.push_back(allocateSegmentLocked());
+            }
+            ok = out.open(directory + "/" + written.back(), directIo) && ok;
+            segmentBytes = 0;
+        }
+        ok = ok && out.write(frame.bytes);
+        if (!ok)
+        {
+            break;
+        }
+        segmentBytes += frame.bytes.size();
+        bytesAfter += frame.bytes.size();
+        ++records;
+
+        if (bytesPerSecond > 0)
+        {
+            std::this_thread::sleep_until(
+                writeStart
+                + std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double>(static_cast<double>(bytesAfter) / bytesPerSecond)));
+        }
+    }
+    ok = out.close() && ok;
+
+    // swap: compacted segments first, then the ones appended since the start
+    if (ok)
+    {
+        std::lock_guard lock(mutex);
+        const ManifestLock manifestLock(lockFd);
+        if (shared)
+        {
+            loadManifestLocked();
+        }
+        std::vector<std::string> list = written;
+        for (const auto &segment : segments)
+        {
+            if (std::find(sealed.begin(), sealed.end(), segment) == sealed.end())
+            {
+                list.push_back(segment);
+            }
+        }
+        ok = manifestLock && storeManifestLocked(list);
+        if (ok)
+        {
+            segments = std::move(list);
+        }
+    }
+    mappings.clear();
+    for (const auto &segment : ok ? sealed : written)
+    {
+        std::remove((directory + "/" + segment).c_str());
+    }
+
+    const Milliseconds scanAfter = timeScan();
+    if (ok && directIo)
+    {
+        // the scan read the new segments back into the page cache, they can go again
+        for (const auto &segment : written)
+        {
+            const int fd = ::open((directory + "/" + segment).c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd >= 0)
+            {
+                posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+                ::close(fd);
+            }
+        }
+    }
+
+    std::string result;
+    if (ok)
+    {
+        result = std::format("compacted {} segments into {}: {} -> {} bytes, reclaimed {} bytes, "
+                             "{} live of {} frames, scan {:.1f} ms -> {:.1f} ms, took {:.1f} ms",
+                             sealed.size(),
+                             written.size(),
+                             bytesBefore,
+                             bytesAfter,
+                             bytesBefore - bytesAfter,
+                             records,
+                             frames,
+                             scanBefore.count(),
+                             scanAfter.count(),
+                             Milliseconds(Clock::now() - start).count());
+    }
+    else
+    {
+        result = std::format("compaction failed, archive unchanged ({} segments)", sealed.size());
+    }
+
+    std::lock_guard lock(mutex);
+    lastReport = std::move(result);
+    ::close(compactFd);
+    compactFd = -1;
+    running = false;
+}
@@ -0,0 +1,225 @@
+/**
+ * @file rz_blob_store.cpp
+ * @author ZHENG Robert (robert.hase-zheng.net)
+ * @brief content-addressed store of encoded sections, shared by identical records
+ * @version 0.1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2025 ZHENG Robert
+ *
+ */
+
+#include "includes/rz_blob_store.hpp"
+#include "includes/rz_shared_output.hpp"
+
+#include <QCryptographicHash>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <format>
+
+namespace
+{
+bool readFile(const std::string &path, std::string &data)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat st{};
+    bool ok = fstat(fd, &st) == 0;
+    if (ok)
+    {
+        data.resize(static_cast<std::size_t>(st.st_size));
+        std::size_t done = 0;
+        while (ok && done < data.size())
+        {
+            const ssize_t n = ::read(fd, data.data() + done, data.size() - done);
+            ok = n > 0;
+            done += n > 0 ? static_cast<std::size_t>(n) : 0;
+        }
+    }
+    ::close(fd);
+    return ok;
+}
+
+std::string parentOf(const std::string &path)
+{
+    return path.substr(0, path.rfind('/'));
+}
+
+} // namespace
+
+std::shared_ptr<Rz_blobStore> Rz_blobStore::open(const std::string &outputDirectory)
+{
+    return openShared<Rz_blobStore>(outputDirectory);
+}
+
+std::string Rz_blobStore::digest(std::string_view data)
+{
+    return QCryptographicHash::hash(QByteArrayView(data.data(), static_cast<qsizetype>(data.size())),
+                                    QCryptographicHash::Sha256)
+        .toHex()
+        .toStdString();
+}
+
+Rz_blobStore::Rz_blobStore(std::string outputDirectory)
+    : root(std::move(outputDirectory) + "/" + std::string(directoryName))
+{}
+
+std::string Rz_blobStore::blobPath(std::string_view extension, std::string_view digest) const
+{
+    return std::format("{}/{}/{}{}", root, digest.substr(0, 2), digest, extension);
+}
+
+std::string Rz_blobStore::referencePath(std::string_view record,
+                                        std::string_view section,
+                                        std::string_view extension) const
+{
+    // FNV-1a of the record name spreads the references over 256 directories
+    std::uint32_t hash = 2166136261U;
+    for (const char c : record)
+    {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 16777619U;
+    }
+    return std::format("{}/refs/{:02x}/{}.{}{}", root, hash & 0xFF, record, section, extension);
+}
+
+bool Rz_blobStore::put(std::string_view record,
+                       std::string_view section,
+                       std::string_view extension,
+                       std::string_view data,
+                       std::string &digest,
+                       std::string &error)
+{
+    digest = Rz_blobStore::digest(data);
+    const std::string blob = blobPath(extension, digest);
+    const std::string reference = referencePath(record, section, extension);
+
+    bool created = false;
+    for (int attempt = 0; attempt < 3; ++attempt)
+    {
+        // a new link to the blob, renamed over the previous reference of the record
+        const std::string tmpReference = sharedTmpPath(reference);
+        if (::link(blob.c_str(), tmpReference.c_str()) == 0)
+        {
+            const bool ok = std::rename(tmpReference.c_str(), reference.c_str()) == 0;
+            if (!ok)
+            {
+                error = std::format("{}: {}", reference, std::strerror(errno));
+            }
+            // renaming over a link of the same blob leaves the source in place
+            ::unlink(tmpReference.c_str());
+            if (ok && !created)
+            {
+                ++deduplicated;
+                savedBytes += data.size();
+            }
+            return ok;
+        }
+        if (errno != ENOENT)
+        {
+            error = std::format("{}: {}", blob, std::strerror(errno));
+            return false;
+        }
+
+        // the blob is new (or was collected meanwhile) or a directory is missing
+        if (!createDirectoriesShared(parentOf(blob), error)
+            || !createDirectoriesShared(parentOf(reference), error))
+        {
+            return false;
+        }
+        if (::access(blob.c_str(), F_OK) != 0)
+        {
+            const std::string tmpBlob = sharedTmpPath(blob);
+            if (!writeShared(tmpBlob, data, error))
+            {
+                return false;
+            }
+            // another process storing the same content first is fine
+            if (::link(tmpBlob.c_str(), blob.c_str()) != 0 && errno != EEXIST)
+            {
+                error = std::format("{}: {}", blob, std::strerror(errno));
+                ::unlink(tmpBlob.c_str());
+                return false;
+            }
+            ::unlink(tmpBlob.c_str());
+            created = true;
+            ++stored;
+        }
+    }
+    error = std::format("{}: unable to reference {}", reference, blob);
+    return false;
+}
+
+bool Rz_blobStore::get(std::string_view record,
+                       std::string_view section,
+                       std::string_view extension,
+                       std::string_view digest,
+                       std::string &data) const
+{
+    if (readFile(blobPath(extension, digest), data))
+    {
+        return true;
+    }
+    return readFile(referencePath(record, section, extension), data) && Rz_blobStore::digest(data) == digest;
+}
+
+bool Rz_blobStore::release(std::string_view record, std::string_view section, std::string_view extension)
+{
+    return ::unlink(referencePath(record, section, extension).c_str()) == 0 || errno == ENOENT;
+}
+
+long Rz_blobStore::references(std::string_view extension, std::string_view digest) const
+{
+    struct stat st{};
+    if (::stat(blobPath(extension, digest).c_str(), &st) != 0)
+    {
+        return -1;
+    }
+    return static_cast<long>(st.st_nlink) - 1;
+}
+
+std::uint64_t Rz_blobStore::collect()
+{
+    std::uint64_t removed = 0;
+    std::error_code ec;
+    for (const auto &dir : std::filesystem::directory_iterator(root, ec))
+    {
+        const std::string name = dir.path().filename().string();
+        if (name.size() != 2 || !dir.is_directory(ec))
+        {
+            continue;
+        }
+        for (const auto &file : std::filesystem::directory_iterator(dir.path(), ec))
+        {
+            struct stat st{};
+            // dot files are blobs in flight
+            if (file.path().filename().string().starts_with('.') || ::lstat(file.path().c_str(), &st) != 0
+                || !S_ISREG(st.st_mode) || st.st_nlink > 1)
+            {
+                continue;
+            }
+            if (::unlink(file.path().c_str()) == 0)
+            {
+                ++removed;
+            }
+        }
+    }
+    return removed;
+}
+
+std::string Rz_blobStore::report() const
+{
+    return std::format("sections stored: {}, deduplicated: {}, bytes saved: {}",
+                       stored.load(),
+                       deduplicated.load(),
+                       savedBytes.load());
+}
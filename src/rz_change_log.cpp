@@ -0,0 +1,71 @@
+/**
+ * @file rz_change_log.cpp
+ * @author ZHENG Robert (robert.hase-zheng.net)
+ * @brief change feed of an output folder: one delta per written record
+ * @version 0.1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2025 ZHENG Robert
+ *
+ */
+
+#include "includes/rz_change_log.hpp"
+#include "includes/rz_shared_output.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdint>
+
+namespace
+{
+std::int64_t nowMilliseconds()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+} // namespace
+
+std::shared_ptr<Rz_changeLog> Rz_changeLog::open(const std::string &directory)
+{
+    return openShared<Rz_changeLog>(directory);
+}
+
+std::string Rz_changeLog::entry(std::string_view record, const nlohmann::json &before, const nlohmann::json &after)
+{
+    const nlohmann::json patch = nlohmann::json::diff(before.is_object() ? before : nlohmann::json::object(),
+                                                      after);
+    if (patch.empty())
+    {
+        return {};
+    }
+    const nlohmann::json line{{"record", record}, {"time", nowMilliseconds()}, {"patch", patch}};
+    return line.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace) + "\n";
+}
+
+std::string Rz_changeLog::removal(std::string_view record)
+{
+    const nlohmann::json line{{"record", record}, {"time", nowMilliseconds()}, {"removed", true}};
+    return line.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace) + "\n";
+}
+
+Rz_changeLog::Rz_changeLog(std::string directory)
+    : filePath(std::move(directory) + "/" + std::string(fileName))
+    , fd(::open(filePath.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644))
+{}
+
+Rz_changeLog::~Rz_changeLog()
+{
+    if (fd >= 0)
+    {
+        ::close(fd);
+    }
+}
+
+bool Rz_changeLog::append(std::string_view line)
+{
+    // one write: the offset is taken and the line written atomically
+    return fd >= 0 && ::write(fd, line.data(), line.size()) == static_cast<ssize_t>(line.size());
+}
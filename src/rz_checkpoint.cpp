@@ -0,0 +1,173 @@
+/**
+ * @file rz_checkpoint.cpp
+ * @author ZHENG Robert (robert.hase-zheng.net)
+ * @brief checkpoint journal of an output target: the records already exported
+ * @version 0.1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2025 ZHENG Robert
+ *
+ */
+
+#include "includes/rz_checkpoint.hpp"
+#include "includes/rz_shared_output.hpp"
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <format>
+
+
+std::shared_ptr<Rz_checkpoint> Rz_checkpoint::open(const std::string &directory)
+{
+    return openShared<Rz_checkpoint>(directory);
+}
+
+Rz_checkpoint::Rz_checkpoint(std::string directory)
+    : filePath(std::move(directory) + "/" + std::string(fileName))
+    , fd(::open(filePath.c_str(), O_RDWR | O_APPEND | O_CREAT | O_CLOEXEC, 0644))
+    , lastFlush(std::chrono::steady_clock::now())
+{
+    load();
+}
+
+Rz_checkpoint::~Rz_checkpoint()
+{
+    flush();
+    if (fd >= 0)
+    {
+        ::close(fd);
+    }
+}
+
+/**
+ * @brief Rz_checkpoint::load
+ * @details reads the journal; a last line without newline is a torn batch and cut,
+ * not while another process appends, its batch in flight would look torn
+ */
+void Rz_checkpoint::load()
+{
+    struct stat st{};
+    if (fd < 0 || fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        return;
+    }
+    std::string data(static_cast<std::size_t>(st.st_size), '\0');
+    std::size_t size = 0;
+    while (size < data.size())
+    {
+        const ssize_t n = ::pread(fd, data.data() + size, data.size() - size, static_cast<off_t>(size));
+        if (n <= 0)
+        {
+            break;
+        }
+        size += static_cast<std::size_t>(n);
+    }
+    data.resize(size);
+
+    const std::size_t complete = data.rfind('\n') + 1; // 0 without any newline
+    if (complete < data.size() && lockFile(fd, LOCK_EX | LOCK_NB))
+    {
+        // the size is checked again under the lock, a batch may have been finished meanwhile
+        if (fstat(fd, &st) == 0 && static_cast<std::size_t>(st.st_size) == data.size())
+        {
+            ftruncate(fd, static_cast<off_t>(complete));
+        }
+        lockFile(fd, LOCK_UN);
+    }
+
+    std::string_view lines(data.data(), complete);
+    records.reserve(static_cast<std::size_t>(std::count(lines.begin(), lines.end(), '\n')));
+    while (!lines.empty())
+    {
+        const std::size_t end = lines.find('\n');
+        if (end > 0)
+        {
+            records.emplace(lines.substr(0, end), true);
+        }
+        lines.remove_prefix(end + 1);
+    }
+    resumed = records.size();
+}
+
+bool Rz_checkpoint::contains(const std::string &record) const
+{
+    std::lock_guard lock(mutex);
+    const auto it = records.find(record);
+    return it != records.end() && it->second;
+}
+
+void Rz_checkpoint::complete(const std::string &record)
+{
+    // one record per line
+    if (record.empty() || record.find('\n') != std::string::npos)
+    {
+        return;
+    }
+    std::lock_guard lock(mutex);
+    if (!records.emplace(record, false).second)
+    {
+        return;
+    }
+    pending += record;
+    pending += '\n';
+    if (++pendingRecords >= flushThreshold || std::chrono::steady_clock::now() - lastFlush >= flushInterval)
+    {
+        flushLocked();
+    }
+}
+
+bool Rz_checkpoint::flush()
+{
+    std::lock_guard lock(mutex);
+    return flushLocked();
+}
+
+bool Rz_checkpoint::flushLocked()
+{
+    lastFlush = std::chrono::steady_clock::now();
+    if (pending.empty())
+    {
+        return true;
+    }
+    // the outputs of the batch reach the disk before the journal claims them
+#if defined(__linux__)
+    if (fd < 0 || ::syncfs(fd) != 0 || !lockFile(fd, LOCK_SH))
+#else
+    ::sync();
+    if (fd < 0 || !lockFile(fd, LOCK_SH))
+#endif
+    {
+        return false;
+    }
+    // one write per batch; a short write (file system full) leaves a torn tail
+    std::size_t written = 0;
+    bool ok = true;
+    while (ok && written < pending.size())
+    {
+        const ssize_t n = ::write(fd, pending.data() + written, pending.size() - written);
+        ok = n > 0 || (n < 0 && errno == EINTR);
+        written += n > 0 ? static_cast<std::size_t>(n) : 0;
+    }
+    ok = ok && fdatasync(fd) == 0;
+    lockFile(fd, LOCK_UN);
+    if (ok)
+    {
+        pending.clear();
+        pendingRecords = 0;
+    }
+    return ok;
+}
+
+std::string Rz_checkpoint::report() const
+{
+    std::lock_guard lock(mutex);
+    return std::format("records resumed: {}, completed: {}, skipped: {}",
+                       resumed,
+                       records.size() - resumed,
+                       skippedRecords.load());
+}
@@ -0,0 +1,271 @@
+/**
+ * @file rz_corpus.cpp
+ * @author ZHENG Robert (robert.hase-zheng.net)
+ * @brief generate synthetic record corpora from rz_write_json.schema.json
+ * @version 0.1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2025 ZHENG Robert
+ *
+ * usage: rz_corpus [--count N] [--seed N] [--median-length N] [--unicode R] [--xmp-tail P]
+ *                  [--schema file] <corpus.jsonl>
+ * one record per line: {"PICTURE": {...}, "EXIF": {...}, "IPTC": {...}, "XMP": {...}},
+ * all values are strings as handed over by the host through setQHash()
+ *
+ */
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "includes/rz_config.hpp"
+
+using json = nlohmann::json;
+
+namespace
+{
+struct Field
+{
+    std::string name;
+    std::string type;
+};
+
+struct Section
+{
+    std::string name; // PICTURE, EXIF, IPTC, XMP
+    std::vector<Field> fields;
+};
+
+/**
+ * @brief sectionsFromSchema
+ * @details the definitions "Image_Metadatas_<Section>" with their scalar properties,
+ * references to other definitions are the nested sections and skipped
+ */
+std::vector<Section> sectionsFromSchema(const json &schema)
+{
+    std::vector<Section> sections;
+    const auto definitions = schema.find("definitions");
+    if (definitions == schema.end() || !definitions->is_object())
+    {
+        return sections;
+    }
+    for (auto it = definitions->cbegin(); it != definitions->cend(); ++it)
+    {
+        const std::string &definition = it.key();
+        const auto properties = it.value().find("properties");
+        if (properties == it.value().end())
+        {
+            continue;
+        }
+        Section section;
+        section.name = definition.substr(definition.rfind('_') + 1);
+        std::transform(section.name.begin(), section.name.end(), section.name.begin(), [](unsigned char c) {
+            return static_cast<char>(std::toupper(c));
+        });
+        for (auto p = properties->cbegin(); p != properties->cend(); ++p)
+        {
+            if (p.value().contains("type"))
+            {
+                section.fields.push_back({p.key(), p.value().value("type", "string")});
+            }
+        }
+        sections.push_back(std::move(section));
+    }
+    return sections;
+}
+
+/**
+ * @brief The Generator class
+ * @details words of a synthetic vocabulary, picked with a Zipf-like skew so keywords
+ * repeat across records; a share of the words is non-ASCII (Latin-1, Cyrillic, CJK and
+ * emoji outside the BMP, i.e. UTF-16 surrogate pairs)
+ */
+class Generator
+{
+public:
+    Generator(std::uint32_t seed, double medianLength, double unicode, double xmpTail)
+        : rng(seed)
+        , length(std::log(std::max(1.0, medianLength)), 0.8)
+        , unicodeShare(unicode)
+        , tailShare(xmpTail)
+    {
+        static const std::vector<std::string> syllables{"ka", "lo", "mi", "ne", "ro", "sa", "tu", "ve",
+                                                        "bri", "dan", "el", "for", "gur", "hal", "in", "jor"};
+        static const std::vector<std::string> unicodeWords{"Größe", "Straße", "café", "niño", "Ærø",
+                                                           "Москва", "озеро", "東京", "北京市", "山",
+                                                           "😀", "🏔️", "🌊", "Zürich", "Ελλάδα"};
+        std::uniform_int_distribution<std::size_t> pick(0, syllables.size() - 1);
+        std::uniform_int_distribution<int> parts(1, 3);
+        for (int i = 0; i < 2000; ++i)
+        {
+            std::string word;
+            for (int n = parts(rng); n > 0; --n)
+            {
+                word += syllables[pick(rng)];
+            }
+            asciiWords.push_back(std::move(word));
+        }
+        nonAsciiWords = unicodeWords;
+    }
+
+    std::string text(std::size_t bytes)
+    {
+        std::string out;
+        while (out.size() < bytes)
+        {
+            if (!out.empty())
+            {
+                out.push_back(' ');
+            }
+            out += word();
+        }
+        return out;
+    }
+
+    std::string value(const Field &field, const std::string &fileName, bool xmp)
+    {
+        if (field.name == "file_name")
+        {
+            return fileName;
+        }
+        if (field.type == "number")
+        {
+            return std::to_string(std::uniform_int_distribution<int>(1, 10'000'000)(rng));
+        }
+        if (field.type == "integer")
+        {
+            return std::to_string(std::uniform_int_distribution<long long>(946'684'800, 1'893'456'000)(rng));
+        }
+        // the heavy tail: a few XMP descriptions of tens of KiB up to MiB
+        if (xmp && field.name == "description" && std::bernoulli_distribution(tailShare)(rng))
+        {
+            const double u = std::uniform_real_distribution<double>(1e-9, 1.0)(rng);
+            const double size = std::min(16.0 * 1024 * std::pow(1.0 / u, 1.0 / 1.2), 4.0 * 1024 * 1024);
+            return text(static_cast<std::size_t>(size));
+        }
+        return text(static_cast<std::size_t>(std::clamp(length(rng), 1.0, 4096.0)));
+    }
+
+private:
+    std::mt19937 rng;
+    std::lognormal_distribution<double> length;
+    double unicodeShare;
+    double tailShare;
+    std::vector<std::string> asciiWords;
+    std::vector<std::string> nonAsciiWords;
+
+    const std::string &word()
+    {
+        if (std::bernoulli_distribution(unicodeShare)(rng))
+        {
+            return nonAsciiWords[std::uniform_int_distribution<std::size_t>(0, nonAsciiWords.size() - 1)(rng)];
+        }
+        // Zipf-like: low indices are frequent
+        const double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        const auto index = static_cast<std::size_t>(std::pow(u, 3.0) * static_cast<double>(asciiWords.size()));
+        return asciiWords[std::min(index, asciiWords.size() - 1)];
+    }
+};
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("rz_corpus");
+    QCoreApplication::setApplicationVersion(QString::fromStdString(PROJECT_VERSION));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("generate a synthetic metadata corpus from the record schema");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("corpus", "output file, JSON Lines");
+    const QCommandLineOption countOption({"n", "count"}, "number of records", "N", "10000");
+    const QCommandLineOption seedOption({"s", "seed"}, "random seed", "N", "42");
+    const QCommandLineOption lengthOption({"l", "median-length"}, "median value length in bytes", "N", "16");
+    const QCommandLineOption unicodeOption({"u", "unicode"}, "share of non-ASCII words, 0..1", "R", "0.1");
+    const QCommandLineOption tailOption({"t", "xmp-tail"},
+                                        "share of records with a large XMP description, 0..1",
+                                        "P",
+                                        "0.01");
+    const QCommandLineOption schemaOption({"c", "schema"},
+                                          "record schema",
+                                          "file",
+                                          "schemas/rz_write_json.schema.json");
+    parser.addOption(countOption);
+    parser.addOption(seedOption);
+    parser.addOption(lengthOption);
+    parser.addOption(unicodeOption);
+    parser.addOption(tailOption);
+    parser.addOption(schemaOption);
+    parser.process(app);
+
+    const QStringList args = parser.positionalArguments();
+    if (args.size() != 1)
+    {
+        parser.showHelp(EXIT_FAILURE);
+    }
+
+    QFile schemaFile(parser.value(schemaOption));
+    if (!schemaFile.open(QIODevice::ReadOnly))
+    {
+        std::cerr << std::format("unable to read schema {}\n", schemaFile.fileName().toStdString());
+        return EXIT_FAILURE;
+    }
+    const json schema = json::parse(schemaFile.readAll().toStdString(), nullptr, false);
+    const std::vector<Section> sections = sectionsFromSchema(schema);
+    if (sections.empty())
+    {
+        std::cerr << std::format("no sections in schema {}\n", schemaFile.fileName().toStdString());
+        return EXIT_FAILURE;
+    }
+
+    QFile out(args.at(0));
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        std::cerr << std::format("unable to write {}\n", args.at(0).toStdString());
+        return EXIT_FAILURE;
+    }
+
+    const long long count = std::max(0LL, parser.value(countOption).toLongLong());
+    Generator generator(parser.value(seedOption).toUInt(),
+                        parser.value(lengthOption).toDouble(),
+                        std::clamp(parser.value(unicodeOption).toDouble(), 0.0, 1.0),
+                        std::clamp(parser.value(tailOption).toDouble(), 0.0, 1.0));
+
+    std::uint64_t bytes = 0;
+    for (long long i = 0; i < count; ++i)
+    {
+        const std::string fileName = std::format("IMG_{:08}.jpg", i);
+        json record = json::object();
+        for (const auto &section : sections)
+        {
+            json &values = record[section.name] = json::object();
+            for (const auto &field : section.fields)
+            {
+                values[field.name] = generator.value(field, fileName, section.name == "XMP");
+            }
+        }
+        const std::string line = record.dump() + "\n";
+        if (out.write(line.data(), static_cast<qint64>(line.size())) != static_cast<qint64>(line.size()))
+        {
+            std::cerr << std::format("unable to write {}\n", args.at(0).toStdString());
+            return EXIT_FAILURE;
+        }
+        bytes += line.size();
+    }
+
+    std::cout << std::format("records: {} sections: {} size: {:.1f} MB\n", count, sections.size(), bytes / 1e6);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,247 @@
+/**
+ * @file rz_direct_writer.cpp
+ * @author ZHENG Robert (robert.hase-zheng.net)
+ * @brief large sequential files past the page cache
+ * @version 0.1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2025 ZHENG Robert
+ *
+ */
+
+#include "includes/rz_direct_writer.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+void Rz_directWriter::startWriteback(int fd, std::uint64_t offset, std::uint64_t size)
+{
+#if defined(SYNC_FILE_RANGE_WRITE)
+    sync_file_range(fd, static_cast<off_t>(offset), static_cast<off_t>(size), SYNC_FILE_RANGE_WRITE);
+#else
+    (void) fd;
+    (void) offset;
+    (void) size;
+#endif
+}
+
+void Rz_directWriter::dropWritten(int fd, std::uint64_t offset, std::uint64_t size)
+{
+#if defined(SYNC_FILE_RANGE_WRITE)
+    sync_file_range(fd,
+                    static_cast<off_t>(offset),
+                    static_cast<off_t>(size),
+                    SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+#else
+    fdatasync(fd);
+#endif
+    posix_fadvise(fd, static_cast<off_t>(offset), static_cast<off_t>(size), POSIX_FADV_DONTNEED);
+}
+
+Rz_directWriter::~Rz_directWriter()
+{
+    close();
+    for (char *buffer : buffers)
+    {
+        std::free(buffer);
+    }
+}
+
+bool Rz_directWriter::open(const std::string &path, bool direct)
+{
+    close();
+    for (char *&buffer : buffers)
+    {
+        if (buffer == nullptr && posix_memalign(reinterpret_cast<void **>(&buffer), alignment, blockSize) != 0)
+        {
+            buffer = nullptr;
+            return false;
+        }
+    }
+
+    directIo = false;
+    writeBehind = false;
+#if defined(O_DIRECT)
+    if (direct)
+    {
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC | O_DIRECT, 0644);
+        directIo = fd >= 0;
+    }
+#endif
+    if (fd < 0)
+    {
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        writeBehind = direct;
+    }
+    if (fd < 0)
+    {
+        return false;
+    }
+    if (writeBehind)
+    {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+
+    current = 0;
+    filled = 0;
+    written = 0;
+    offset = 0;
+    block = nullptr;
+    stopping = false;
+    failed = false;
+    worker = std::thread(&Rz_directWriter::run, this);
+    return true;
+}
+
+bool Rz_directWriter::write(std::string_view data)
+{
+    if (fd < 0)
+    {
+        return false;
+    }
+    while (!data.empty())
+    {
+        const std::size_t n = std::min(data.size(), blockSize - filled);
+        std::memcpy(buffers[current] + filled, data.data(), n);
+        filled += n;
+        written += n;
+        data.remove_prefix(n);
+        if (filled == blockSize && !submitBlock(blockSize))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Rz_directWriter::close()
+{
+    if (fd < 0)
+    {
+        return true;
+    }
+    // idle first: the thread drops O_DIRECT if the file system refuses it
+    bool ok = waitIdle();
+    if (filled > 0)
+    {
+        // O_DIRECT writes whole aligned blocks: zero padding, trimmed below
+        const std::size_t size = directIo ? (filled + alignment - 1) / alignment * alignment : filled;
+        std::memset(buffers[current] + filled, 0, size - filled);
+        ok = submitBlock(size);
+    }
+    ok = waitIdle() && ok;
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    worker.join();
+
+    ok = ftruncate(fd, static_cast<off_t>(written)) == 0 && ok;
+    ok = fsync(fd) == 0 && ok;
+    if (writeBehind)
+    {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    }
+    ok = ::close(fd) == 0 && ok;
+    fd = -1;
+    return ok;
+}
+
+/**
+ * @brief Rz_directWriter::submitBlock
+ * @details hands the filled buffer to the thread once the previous block is written,
+ * the other buffer is filled meanwhile
+ */
+bool Rz_directWriter::submitBlock(std::size_t size)
+{
+    if (!waitIdle())
+    {
+        return false;
+    }
+    {
+        std::lock_guard lock(mutex);
+        block = buffers[current];
+        blockBytes = size;
+        blockOffset = offset;
+    }
+    changed.notify_all();
+    offset += size;
+    current ^= 1;
+    filled = 0;
+    return true;
+}
+
+bool Rz_directWriter::waitIdle()
+{
+    std::unique_lock lock(mutex);
+    changed.wait(lock, [this] { return block == nullptr; });
+    return !failed;
+}
+
+bool Rz_directWriter::writeBlock(const char *data, std::size_t size, std::uint64_t at)
+{
+    std::size_t done = 0;
+    while (done < size)
+    {
+        const ssize_t n = ::pwrite(fd, data + done, size - done, static_cast<off_t>(at + done));
+#if defined(O_DIRECT)
+        if (n < 0 && errno == EINVAL && directIo)
+        {
+            // opened with O_DIRECT, but the file system refuses it for writes
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_DIRECT);
+            directIo = false;
+            writeBehind = true;
+            continue;
+        }
+#endif
+        if (n <= 0)
+        {
+            return false;
+        }
+        done += static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+void Rz_directWriter::run()
+{
+    std::uint64_t previousOffset = 0;
+    std::uint64_t previousSize = 0;
+    std::unique_lock lock(mutex);
+    while (true)
+    {
+        changed.wait(lock, [this] { return stopping || block != nullptr; });
+        if (block == nullptr)
+        {
+            return;
+        }
+        const char *data = block;
+        const std::size_t size = blockBytes;
+        const std::uint64_t at = blockOffset;
+        lock.unlock();
+
+        bool ok = writeBlock(data, size, at);
+        if (ok && writeBehind)
+        {
+            // the page cache holds at most the last two blocks
+            startWriteback(fd, at, size);
+            if (previousSize > 0)
+            {
+                dropWritten(fd, previousOffset, previousSize);
+            }
+            previousOffset = at;
+            previousSize = size;
+        }
+
+        lock.lock();
+        failed = failed || !ok;
+        block = nullptr;
+        changed.notify_all();
+    }
+}
@@ -0,0 +1,165 @@
+/**
+ * @file rz_meta_record.cpp
+ * @author ZHENG Robert (robert.hase-zheng.net)
+ * @brief compact storage of the PICTURE, EXIF, IPTC and XMP data of one record
+ * @version 0.1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2025 ZHENG Robert
+ *
+ */
+
+#include "includes/rz_meta_record.hpp"
+
+#include <algorithm>
+
+void Rz_metaRecord::beginSection(Rz_section section)
+{
+    current = section;
+    pending.clear();
+
+    const std::size_t s = index(section);
+    const std::uint32_t first = begin[s];
+    const std::uint32_t last = begin[s + 1];
+    for (std::uint32_t i = first; i < last; ++i)
+    {
+        deadBytes += entries[i].keySize + entries[i].valueSize;
+    }
+    entries.erase(entries.begin() + first, entries.begin() + last);
+    for (std::size_t i = s + 1; i <= sectionCount; ++i)
+    {
+        begin[i] -= last - first;
+    }
+    present[s] = false;
+}
+
+bool Rz_metaRecord::add(const Rz_text &key, const Rz_text &value)
+{
+    // the UTF-8 sizes are known once appended
+    const std::size_t keyOffset = buffer.size();
+    Rz_streamEncoder::appendUtf8(buffer, key);
+    const std::size_t valueOffset = buffer.size();
+    Rz_streamEncoder::appendUtf8(buffer, value);
+    if (buffer.size() > maxBytes || entries.size() + pending.size() >= maxBytes)
+    {
+        buffer.resize(keyOffset);
+        return false;
+    }
+
+    Entry entry{};
+    entry.keyOffset = static_cast<std::uint32_t>(keyOffset);
+    entry.keySize = static_cast<std::uint32_t>(valueOffset - keyOffset);
+    entry.valueOffset = static_cast<std::uint32_t>(valueOffset);
+    entry.valueSize = static_cast<std::uint32_t>(buffer.size() - valueOffset);
+    pending.push_back(entry);
+    return true;
+}
+
+void Rz_metaRecord::endSection()
+{
+    std::stable_sort(pending.begin(), pending.end(), [this](const Entry &lhs, const Entry &rhs) {
+        return key(lhs) < key(rhs);
+    });
+    // keep the last of equal keys
+    const auto last = std::unique(pending.rbegin(),
+                                  pending.rend(),
+                                  [this](const Entry &lhs, const Entry &rhs) {
+                                      return key(lhs) == key(rhs);
+                                  });
+    pending.erase(pending.begin(), last.base());
+
+    const std::size_t s = index(current);
+    entries.insert(entries.begin() + begin[s + 1], pending.begin(), pending.end());
+    for (std::size_t i = s + 1; i <= sectionCount; ++i)
+    {
+        begin[i] += static_cast<std::uint32_t>(pending.size());
+    }
+    present[s] = true;
+    pending.clear();
+
+    if (deadBytes > buffer.size() / 2)
+    {
+        compact();
+    }
+}
+
+void Rz_metaRecord::clear()
+{
+    buffer.clear();
+    entries.clear();
+    pending.clear();
+    begin.fill(0);
+    present.fill(false);
+    deadBytes = 0;
+
+    if (buffer.capacity() > retainCapacity)
+    {
+        std::string().swap(buffer);
+    }
+    if (entries.capacity() * sizeof(Entry) > retainCapacity)
+    {
+        std::vector<Entry>().swap(entries);
+    }
+}
+
+void Rz_metaRecord::release()
+{
+    clear();
+    std::string().swap(buffer);
+    std::vector<Entry>().swap(entries);
+    std::vector<Entry>().swap(pending);
+}
+
+std::span<const Rz_metaRecord::Entry> Rz_metaRecord::section(Rz_section section) const
+{
+    const std::size_t s = index(section);
+    return std::span<const Entry>(entries.data() + begin[s], begin[s + 1] - begin[s]);
+}
+
+std::string_view Rz_metaRecord::key(const Entry &entry) const
+{
+    return std::string_view(buffer.data() + entry.keyOffset, entry.keySize);
+}
+
+std::string_view Rz_metaRecord::value(const Entry &entry) const
+{
+    return std::string_view(buffer.data() + entry.valueOffset, entry.valueSize);
+}
+
+std::optional<std::string_view> Rz_metaRecord::find(Rz_section section, std::string_view key) const
+{
+    const auto range = this->section(section);
+    const auto it = std::lower_bound(range.begin(),
+                                     range.end(),
+                                     key,
+                                     [this](const Entry &entry, std::string_view k) {
+                                         return this->key(entry) < k;
+                                     });
+    if (it == range.end() || this->key(*it) != key)
+    {
+        return std::nullopt;
+    }
+    return value(*it);
+}
+
+std::size_t Rz_metaRecord::memoryUsage() const
+{
+    return buffer.capacity() + (entries.capacity() + pending.capacity()) * sizeof(Entry);
+}
+
+void Rz_metaRecord::compact()
+{
+    std::string live;
+    live.reserve(buffer.size() - deadBytes);
+    for (auto &entry : entries)
+    {
+        const auto k = key(entry);
+        const auto v = value(entry);
+        entry.keyOffset = static_cast<std::uint32_t>(live.size());
+        live.append(k);
+        entry.valueOffset = static_cast<std::uint32_t>(live.size());
+        live.append(v);
+    }
+    buffer.swap(live);
+    deadBytes = 0;
+}
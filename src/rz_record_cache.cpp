@@ -0,0 +1,149 @@
+/**
+ * @file rz_record_cache.cpp
+ * @author ZHENG Robert (robert.hase-zheng.net)
+ * @brief read-through cache of decoded records
+ * @version 0.1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2025 ZHENG Robert
+ *
+ */
+
+#include "includes/rz_record_cache.hpp"
+
+#include <sys/stat.h>
+
+#include <format>
+#include <functional>
+#include <iterator>
+
+namespace
+{
+// bookkeeping of an entry besides the record: list node, index slot, path
+constexpr std::size_t nodeOverhead{128};
+} // namespace
+
+Rz_recordCache &Rz_recordCache::instance()
+{
+    static Rz_recordCache cache;
+    return cache;
+}
+
+bool Rz_recordCache::stamp(const std::string &path, Stamp &stamp)
+{
+    struct stat st{};
+    if (::stat(path.c_str(), &st) != 0)
+    {
+        return false;
+    }
+    stamp.inode = static_cast<std::uint64_t>(st.st_ino);
+    stamp.size = static_cast<std::uint64_t>(st.st_size);
+    stamp.modified = static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    return true;
+}
+
+void Rz_recordCache::setCapacity(std::size_t bytes)
+{
+    capacityBytes.store(bytes, std::memory_order_relaxed);
+    for (auto &shard : shards)
+    {
+        std::lock_guard lock(shard.mutex);
+        evictLocked(shard, bytes / shardCount);
+    }
+}
+
+std::shared_ptr<const Rz_metaRecord> Rz_recordCache::find(const std::string &path, const Stamp &stamp)
+{
+    Shard &shard = shardOf(path);
+    std::lock_guard lock(shard.mutex);
+    const auto it = shard.index.find(path);
+    if (it == shard.index.end())
+    {
+        ++misses;
+        return nullptr;
+    }
+    if (!(it->second->stamp == stamp))
+    {
+        // the file was replaced or changed since
+        eraseLocked(shard, it->second);
+        ++misses;
+        ++invalidations;
+        return nullptr;
+    }
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+    ++hits;
+    return it->second->record;
+}
+
+void Rz_recordCache::insert(const std::string &path, const Stamp &stamp, std::shared_ptr<const Rz_metaRecord> record)
+{
+    const std::size_t limit = capacity() / shardCount;
+    const std::size_t bytes = record->memoryUsage() + path.size() + nodeOverhead;
+    if (bytes > limit)
+    {
+        return;
+    }
+
+    Shard &shard = shardOf(path);
+    std::lock_guard lock(shard.mutex);
+    if (const auto it = shard.index.find(path); it != shard.index.end())
+    {
+        eraseLocked(shard, it->second);
+    }
+    evictLocked(shard, limit - bytes);
+    shard.lru.push_front(Node{path, stamp, std::move(record), bytes});
+    shard.index.emplace(path, shard.lru.begin());
+    shard.bytes += bytes;
+}
+
+void Rz_recordCache::invalidate(const std::string &path)
+{
+    Shard &shard = shardOf(path);
+    std::lock_guard lock(shard.mutex);
+    if (const auto it = shard.index.find(path); it != shard.index.end())
+    {
+        eraseLocked(shard, it->second);
+        ++invalidations;
+    }
+}
+
+std::string Rz_recordCache::report() const
+{
+    std::size_t records = 0;
+    std::size_t bytes = 0;
+    for (const auto &shard : shards)
+    {
+        std::lock_guard lock(shard.mutex);
+        records += shard.index.size();
+        bytes += shard.bytes;
+    }
+    return std::format("hits: {}, misses: {}, evictions: {}, invalidations: {}, records: {}, bytes: {} of {}",
+                       hits.load(),
+                       misses.load(),
+                       evictions.load(),
+                       invalidations.load(),
+                       records,
+                       bytes,
+                       capacity());
+}
+
+Rz_recordCache::Shard &Rz_recordCache::shardOf(const std::string &path)
+{
+    return shards[std::hash<std::string>{}(path) % shardCount];
+}
+
+void Rz_recordCache::eraseLocked(Shard &shard, std::list<Node>::iterator node)
+{
+    shard.bytes -= node->bytes;
+    shard.index.erase(node->path);
+    shard.lru.erase(node);
+}
+
+void Rz_recordCache::evictLocked(Shard &shard, std::size_t limit)
+{
+    while (shard.bytes > limit && !shard.lru.empty())
+    {
+        eraseLocked(shard, std::prev(shard.lru.end()));
+        ++evictions;
+    }
+}
@@ -0,0 +1,144 @@
+/**
+ * @file rz_record_codec.cpp
+ * @author ZHENG Robert (robert.hase-zheng.net)
+ * @brief decode exported records and feed them back into the stream encoder
+ * @version 0.1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2025 ZHENG Robert
+ *
+ */
+
+#include "includes/rz_record_codec.hpp"
+
+#include <array>
+#include <utility>
+
+using json = nlohmann::json;
+
+namespace
+{
+struct FormatEntry
+{
+    OutputFormat format;
+    std::string_view name;
+    std::string_view extension;
+};
+
+constexpr std::array<FormatEntry, 6> formatTable{{{OutputFormat::JSON, "JSON", ".json"},
+                                                  {OutputFormat::BSON, "BSON", ".bson"},
+                                                  {OutputFormat::CBOR, "CBOR", ".cbor"},
+                                                  {OutputFormat::MSGPACK, "MSGPACK", ".msgpack"},
+                                                  {OutputFormat::UBJSON, "UBJSON", ".ubjson"},
+                                                  {OutputFormat::BJDATA, "BJDATA", ".bjdata"}}};
+} // namespace
+
+std::optional<OutputFormat> outputFormatFromName(std::string_view name)
+{
+    for (const auto &entry : formatTable)
+    {
+        if (entry.name == name)
+        {
+            return entry.format;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<OutputFormat> outputFormatFromExtension(std::string_view ext)
+{
+    for (const auto &entry : formatTable)
+    {
+        if (entry.extension == ext)
+        {
+            return entry.format;
+        }
+    }
+    return std::nullopt;
+}
+
+std::string_view outputFormatExtension(OutputFormat fmt)
+{
+    for (const auto &entry : formatTable)
+    {
+        if (entry.format == fmt)
+        {
+            return entry.extension;
+        }
+    }
+    return {};
+}
+
+bool decodeRecord(OutputFormat fmt, const std::uint8_t *data, std::size_t size, json &record)
+{
+    const std::uint8_t *end = data + size;
+
+    switch (fmt)
+    {
+    case OutputFormat::JSON:
+        record = json::parse(data, end, nullptr, false);
+        break;
+    case OutputFormat::BSON:
+        record = json::from_bson(data, end, true, false);
+        break;
+    case OutputFormat::CBOR:
+        record = json::from_cbor(data, end, true, false);
+        break;
+    case OutputFormat::MSGPACK:
+        record = json::from_msgpack(data, end, true, false);
+        break;
+    case OutputFormat::UBJSON:
+        record = json::from_ubjson(data, end, true, false);
+        break;
+    case OutputFormat::BJDATA:
+        record = json::from_bjdata(data, end, true, false);
+        break;
+    }
+    return !record.is_discarded() && record.is_object();
+}
+
+bool Rz_recordNodes::assign(const json &record)
+{
+    rootNodes.clear();
+    sections.clear();
+    scalars.clear();
+
+    if (!record.is_object())
+    {
+        return false;
+    }
+    return assignObject(record, rootNodes);
+}
+
+bool Rz_recordNodes::assignObject(const json &object, std::vector<Rz_streamEncoder::Node> &nodes)
+{
+    // nlohmann::json objects iterate in key order, as the encoder expects
+    nodes.reserve(object.size());
+    for (auto it = object.cbegin(); it != object.cend(); ++it)
+    {
+        const std::string_view keyView{it.key()};
+        const json &value = it.value();
+        if (value.is_object())
+        {
+            auto &children = sections.emplace_back();
+            if (!assignObject(value, children))
+            {
+                return false;
+            }
+            nodes.push_back({keyView, std::string_view{}, &children});
+        }
+        else if (value.is_string())
+        {
+            nodes.push_back({keyView, std::string_view{value.get_ref<const std::string &>()}});
+        }
+        else if (value.is_array() || value.is_binary())
+        {
+            return false;
+        }
+        else
+        {
+            nodes.push_back({keyView, std::string_view{scalars.emplace_back(value.dump())}});
+        }
+    }
+    return true;
+}
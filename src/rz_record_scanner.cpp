@@ -0,0 +1,919 @@
+/**
+ * @file rz_record_scanner.cpp
+ * @author ZHENG Robert (robert.hase-zheng.net)
+ * @brief locate the top-level members of an encoded record without decoding it
+ * @version 0.1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2025 ZHENG Robert
+ *
+ */
+
+#include "includes/rz_record_scanner.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+#include <nlohmann/json.hpp>
+
+namespace
+{
+constexpr int maxDepth{64};
+
+/**
+ * @brief The Cursor struct
+ * @details bounds-checked reader over the encoded bytes
+ */
+struct Cursor
+{
+    std::string_view data;
+    std::size_t pos{0};
+    bool ok{true};
+
+    bool has(std::size_t n) const { return ok && n <= data.size() - pos; }
+
+    std::uint8_t byte()
+    {
+        if (!has(1))
+        {
+            ok = false;
+            return 0;
+        }
+        return static_cast<std::uint8_t>(data[pos++]);
+    }
+
+    std::uint8_t peek() const { return has(1) ? static_cast<std::uint8_t>(data[pos]) : 0; }
+
+    bool skip(std::uint64_t n)
+    {
+        if (!has(n))
+        {
+            ok = false;
+            return false;
+        }
+        pos += n;
+        return true;
+    }
+
+    std::uint64_t bigEndian(int bytes)
+    {
+        std::uint64_t value = 0;
+        for (int i = 0; i < bytes; ++i)
+        {
+            value = (value << 8) | byte();
+        }
+        return value;
+    }
+
+    std::uint64_t littleEndian(int bytes)
+    {
+        std::uint64_t value = 0;
+        for (int i = 0; i < bytes; ++i)
+        {
+            value |= static_cast<std::uint64_t>(byte()) << (8 * i);
+        }
+        return value;
+    }
+};
+
+// CBOR -----------------------------------------------------------------------
+
+bool cborHeader(Cursor &c, std::uint8_t &major, std::uint64_t &value, bool &indefinite)
+{
+    const std::uint8_t ib = c.byte();
+    major = ib >> 5;
+    const std::uint8_t info = ib & 0x1F;
+    indefinite = false;
+    if (info < 24)
+    {
+        value = info;
+    }
+    else if (info <= 27)
+    {
+        value = c.bigEndian(1 << (info - 24));
+    }
+    else if (info == 31 && (major >= 2 && major <= 5))
+    {
+        indefinite = true;
+    }
+    else if (!(info == 31 && major == 7))
+    {
+        c.ok = false;
+    }
+    return c.ok;
+}
+
+bool skipCbor(Cursor &c, int depth)
+{
+    std::uint8_t major = 0;
+    std::uint64_t value = 0;
+    bool indefinite = false;
+    if (depth > maxDepth || !cborHeader(c, major, value, indefinite))
+    {
+        return false;
+    }
+
+    switch (major)
+    {
+    case 2:
+    case 3:
+        if (!indefinite)
+        {
+            return c.skip(value);
+        }
+        while (c.ok && c.peek() != 0xFF)
+        {
+            std::uint8_t chunkMajor = 0;
+            if (!cborHeader(c, chunkMajor, value, indefinite) || chunkMajor != major || indefinite)
+            {
+                return false;
+            }
+            c.skip(value);
+        }
+        return c.byte() == 0xFF && c.ok;
+    case 4:
+    case 5:
+    {
+        const std::uint64_t items = major == 5 ? 2 : 1;
+        if (indefinite)
+        {
+            while (c.ok && c.peek() != 0xFF)
+            {
+                skipCbor(c, depth + 1);
+            }
+            return c.byte() == 0xFF && c.ok;
+        }
+        for (std::uint64_t i = 0; i < value * items && c.ok; ++i)
+        {
+            skipCbor(c, depth + 1);
+        }
+        return c.ok;
+    }
+    case 6:
+        return skipCbor(c, depth + 1);
+    default:
+        return c.ok;
+    }
+}
+
+bool cborKey(Cursor &c, std::string &key)
+{
+    std::uint8_t major = 0;
+    std::uint64_t size = 0;
+    bool indefinite = false;
+    if (!cborHeader(c, major, size, indefinite) || major != 3 || indefinite || !c.has(size))
+    {
+        return false;
+    }
+    key.assign(c.data.substr(c.pos, size));
+    return c.skip(size);
+}
+
+bool scanCbor(Cursor &c, std::vector<Rz_scanEntry> &entries)
+{
+    std::uint8_t major = 0;
+    std::uint64_t count = 0;
+    bool indefinite = false;
+    if (!cborHeader(c, major, count, indefinite) || major != 5)
+    {
+        return false;
+    }
+    for (std::uint64_t i = 0; indefinite ? c.peek() != 0xFF : i < count; ++i)
+    {
+        Rz_scanEntry entry;
+        if (!cborKey(c, entry.key))
+        {
+            return false;
+        }
+        entry.offset = c.pos;
+        entry.object = (c.peek() >> 5) == 5;
+        if (!skipCbor(c, 1))
+        {
+            return false;
+        }
+        entry.size = c.pos - entry.offset;
+        entries.push_back(std::move(entry));
+    }
+    return !indefinite || c.byte() == 0xFF;
+}
+
+// MessagePack ----------------------------------------------------------------
+
+bool skipMsgpack(Cursor &c, int depth)
+{
+    if (depth > maxDepth)
+    {
+        return false;
+    }
+    const std::uint8_t b = c.byte();
+    std::uint64_t items = 0;
+
+    if (b <= 0x7F || b >= 0xE0 || b == 0xC0 || b == 0xC2 || b == 0xC3)
+    {
+        return c.ok;
+    }
+    if (b >= 0xA0 && b <= 0xBF)
+    {
+        return c.skip(b & 0x1F);
+    }
+    if (b >= 0x80 && b <= 0x8F)
+    {
+        items = 2 * static_cast<std::uint64_t>(b & 0x0F);
+    }
+    else if (b >= 0x90 && b <= 0x9F)
+    {
+        items = b & 0x0F;
+    }
+    else
+    {
+        switch (b)
+        {
+        case 0xC4:
+        case 0xD9:
+            return c.skip(c.bigEndian(1));
+        case 0xC5:
+        case 0xDA:
+            return c.skip(c.bigEndian(2));
+        case 0xC6:
+        case 0xDB:
+            return c.skip(c.bigEndian(4));
+        case 0xC7:
+            return c.skip(c.bigEndian(1) + 1);
+        case 0xC8:
+            return c.skip(c.bigEndian(2) + 1);
+        case 0xC9:
+            return c.skip(c.bigEndian(4) + 1);
+        case 0xCC:
+        case 0xD0:
+            return c.skip(1);
+        case 0xCD:
+        case 0xD1:
+            return c.skip(2);
+        case 0xCA:
+        case 0xCE:
+        case 0xD2:
+            return c.skip(4);
+        case 0xCB:
+        case 0xCF:
+        case 0xD3:
+            return c.skip(8);
+        case 0xD4:
+            return c.skip(2);
+        case 0xD5:
+            return c.skip(3);
+        case 0xD6:
+            return c.skip(5);
+        case 0xD7:
+            return c.skip(9);
+        case 0xD8:
+            return c.skip(17);
+        case 0xDC:
+            items = c.bigEndian(2);
+            break;
+        case 0xDD:
+            items = c.bigEndian(4);
+            break;
+        case 0xDE:
+            items = 2 * c.bigEndian(2);
+            break;
+        case 0xDF:
+            items = 2 * c.bigEndian(4);
+            break;
+        default:
+            return false;
+        }
+    }
+    for (std::uint64_t i = 0; i < items && c.ok; ++i)
+    {
+        skipMsgpack(c, depth + 1);
+    }
+    return c.ok;
+}
+
+bool msgpackKey(Cursor &c, std::string &key)
+{
+    const std::uint8_t b = c.byte();
+    std::uint64_t size = 0;
+    if (b >= 0xA0 && b <= 0xBF)
+    {
+        size = b & 0x1F;
+    }
+    else if (b == 0xD9)
+    {
+        size = c.bigEndian(1);
+    }
+    else if (b == 0xDA)
+    {
+        size = c.bigEndian(2);
+    }
+    else if (b == 0xDB)
+    {
+        size = c.bigEndian(4);
+    }
+    else
+    {
+        return false;
+    }
+    if (!c.has(size))
+    {
+        return false;
+    }
+    key.assign(c.data.substr(c.pos, size));
+    return c.skip(size);
+}
+
+bool scanMsgpack(Cursor &c, std::vector<Rz_scanEntry> &entries)
+{
+    const std::uint8_t b = c.byte();
+    std::uint64_t count = 0;
+    if (b >= 0x80 && b <= 0x8F)
+    {
+        count = b & 0x0F;
+    }
+    else if (b == 0xDE)
+    {
+        count = c.bigEndian(2);
+    }
+    else if (b == 0xDF)
+    {
+        count = c.bigEndian(4);
+    }
+    else
+    {
+        return false;
+    }
+    for (std::uint64_t i = 0; i < count; ++i)
+    {
+        Rz_scanEntry entry;
+        if (!msgpackKey(c, entry.key))
+        {
+            return false;
+        }
+        entry.offset = c.pos;
+        const std::uint8_t t = c.peek();
+        entry.object = (t >= 0x80 && t <= 0x8F) || t == 0xDE || t == 0xDF;
+        if (!skipMsgpack(c, 1))
+        {
+            return false;
+        }
+        entry.size = c.pos - entry.offset;
+        entries.push_back(std::move(entry));
+    }
+    return c.ok;
+}
+
+// UBJSON / BJData --------------------------------------------------------------
+
+/**
+ * @brief ubjsonSize
+ * @return bytes of a fixed-size value of the marker, -1 for other markers
+ */
+int ubjsonSize(std::uint8_t marker, bool bjdata)
+{
+    switch (marker)
+    {
+    case 'Z':
+    case 'N':
+    case 'T':
+    case 'F':
+        return 0;
+    case 'i':
+    case 'U':
+    case 'C':
+        return 1;
+    case 'I':
+        return 2;
+    case 'l':
+    case 'd':
+        return 4;
+    case 'L':
+    case 'D':
+        return 8;
+    case 'u':
+    case 'h':
+        return bjdata ? 2 : -1;
+    case 'm':
+        return bjdata ? 4 : -1;
+    case 'M':
+        return bjdata ? 8 : -1;
+    case 'B':
+        return bjdata ? 1 : -1;
+    default:
+        return -1;
+    }
+}
+
+bool ubjsonInteger(Cursor &c, std::uint8_t marker, bool bjdata, std::uint64_t &value)
+{
+    const int size = ubjsonSize(marker, bjdata);
+    const bool isInteger = marker == 'i' || marker == 'U' || marker == 'I' || marker == 'l'
+                           || marker == 'L' || marker == 'u' || marker == 'm' || marker == 'M';
+    if (!isInteger || size <= 0)
+    {
+        return false;
+    }
+    value = bjdata ? c.littleEndian(size) : c.bigEndian(size);
+    if ((marker == 'i' && (value & 0x80)) || (marker == 'I' && (value & 0x8000))
+        || (marker == 'l' && (value & 0x80000000)) || (marker == 'L' && (value >> 63)))
+    {
+        // negative lengths
+        return false;
+    }
+    return c.ok;
+}
+
+bool skipUbjsonValue(Cursor &c, std::uint8_t marker, bool bjdata, int depth);
+
+bool skipUbjsonContainer(Cursor &c, bool object, bool bjdata, int depth)
+{
+    std::uint8_t type = 0;
+    std::uint64_t count = 0;
+    bool counted = false;
+
+    if (c.peek() == '$')
+    {
+        c.byte();
+        type = c.byte();
+        if (c.byte() != '#')
+        {
+            return false;
+        }
+    }
+    if (type != 0 || c.peek() == '#')
+    {
+        if (type == 0)
+        {
+            c.byte();
+        }
+        if (!ubjsonInteger(c, c.byte(), bjdata, count))
+        {
+            return false;
+        }
+        counted = true;
+    }
+
+    for (std::uint64_t i = 0; counted ? i < count : c.peek() != (object ? '}' : ']'); ++i)
+    {
+        if (!c.ok)
+        {
+            return false;
+        }
+        if (object)
+        {
+            std::uint64_t size = 0;
+            if (!ubjsonInteger(c, c.byte(), bjdata, size) || !c.skip(size))
+            {
+                return false;
+            }
+        }
+        if (!skipUbjsonValue(c, type != 0 ? type : c.byte(), bjdata, depth + 1))
+        {
+            return false;
+        }
+    }
+    if (!counted)
+    {
+        c.byte();
+    }
+    return c.ok;
+}
+
+bool skipUbjsonValue(Cursor &c, std::uint8_t marker, bool bjdata, int depth)
+{
+    if (depth > maxDepth)
+    {
+        return false;
+    }
+    const int size = ubjsonSize(marker, bjdata);
+    if (size >= 0)
+    {
+        return c.skip(size);
+    }
+    switch (marker)
+    {
+    case 'S':
+    case 'H':
+    {
+        std::uint64_t length = 0;
+        return ubjsonInteger(c, c.byte(), bjdata, length) && c.skip(length);
+    }
+    case '[':
+        return skipUbjsonContainer(c, false, bjdata, depth);
+    case '{':
+        return skipUbjsonContainer(c, true, bjdata, depth);
+    default:
+        return false;
+    }
+}
+
+bool scanUbjson(Cursor &c, bool bjdata, std::vector<Rz_scanEntry> &entries)
+{
+    // objects as written by nlohmann::json and Rz_streamEncoder: no '$' / '#'
+    if (c.byte() != '{' || c.peek() == '$' || c.peek() == '#')
+    {
+        return false;
+    }
+    while (c.ok && c.peek() != '}')
+    {
+        Rz_scanEntry entry;
+        std::uint64_t size = 0;
+        if (!ubjsonInteger(c, c.byte(), bjdata, size) || !c.has(size))
+        {
+            return false;
+        }
+        entry.key.assign(c.data.substr(c.pos, size));
+        c.skip(size);
+        entry.offset = c.pos;
+        entry.object = c.peek() == '{';
+        if (!skipUbjsonValue(c, c.byte(), bjdata, 1))
+        {
+            return false;
+        }
+        entry.size = c.pos - entry.offset;
+        entries.push_back(std::move(entry));
+    }
+    return c.byte() == '}' && c.ok;
+}
+
+// BSON -----------------------------------------------------------------------
+
+bool skipBsonValue(Cursor &c, std::uint8_t type)
+{
+    switch (type)
+    {
+    case 0x01: // double
+    case 0x09: // UTC datetime
+    case 0x11: // uint64
+    case 0x12: // int64
+        return c.skip(8);
+    case 0x02: // string
+        return c.skip(c.littleEndian(4));
+    case 0x03: // document
+    case 0x04: // array
+    {
+        const std::uint64_t size = c.littleEndian(4);
+        return size >= 5 && c.skip(size - 4);
+    }
+    case 0x05: // binary
+        return c.skip(c.littleEndian(4) + 1);
+    case 0x07: // ObjectId
+        return c.skip(12);
+    case 0x08: // boolean
+        return c.skip(1);
+    case 0x0A: // null
+        return c.ok;
+    case 0x10: // int32
+        return c.skip(4);
+    default:
+        return false;
+    }
+}
+
+bool scanBson(Cursor &c, std::vector<Rz_scanEntry> &entries)
+{
+    const std::uint64_t size = c.littleEndian(4);
+    if (!c.ok || size < 5 || size > c.data.size())
+    {
+        return false;
+    }
+    c.data = c.data.substr(0, size);
+
+    while (c.ok && c.peek() != 0x00)
+    {
+        const std::uint8_t type = c.byte();
+        const std::size_t end = c.data.find('\0', c.pos);
+        if (end == std::string_view::npos)
+        {
+            return false;
+        }
+        Rz_scanEntry entry;
+        entry.key.assign(c.data.substr(c.pos, end - c.pos));
+        c.pos = end + 1;
+        entry.offset = c.pos;
+        entry.object = type == 0x03;
+        entry.bsonType = type;
+        if (!skipBsonValue(c, type))
+        {
+            return false;
+        }
+        entry.size = c.pos - entry.offset;
+        entries.push_back(std::move(entry));
+    }
+    return c.byte() == 0x00 && c.pos == size;
+}
+
+// JSON -----------------------------------------------------------------------
+
+void skipWhitespace(Cursor &c)
+{
+    while (c.has(1) && std::strchr(" \t\r\n", c.data[c.pos]) != nullptr && c.data[c.pos] != '\0')
+    {
+        ++c.pos;
+    }
+}
+
+bool skipJsonString(Cursor &c)
+{
+    if (c.byte() != '"')
+    {
+        return false;
+    }
+    while (c.ok)
+    {
+        const std::uint8_t b = c.byte();
+        if (b == '\\')
+        {
+            c.byte();
+        }
+        else if (b == '"')
+        {
+            return c.ok;
+        }
+    }
+    return false;
+}
+
+bool skipJsonValue(Cursor &c)
+{
+    skipWhitespace(c);
+    const std::uint8_t first = c.peek();
+    if (first == '"')
+    {
+        return skipJsonString(c);
+    }
+    if (first != '{' && first != '[')
+    {
+        // number, true, false, null
+        while (c.has(1) && std::strchr(",}] \t\r\n", c.data[c.pos]) == nullptr)
+        {
+            ++c.pos;
+        }
+        return c.ok;
+    }
+
+    int depth = 0;
+    while (c.ok)
+    {
+        const std::uint8_t b = c.peek();
+        if (b == '"')
+        {
+            skipJsonString(c);
+            continue;
+        }
+        c.byte();
+        if (b == '{' || b == '[')
+        {
+            if (++depth > maxDepth)
+            {
+                return false;
+            }
+        }
+        else if ((b == '}' || b == ']') && --depth == 0)
+        {
+            return c.ok;
+        }
+    }
+    return false;
+}
+
+bool scanJson(Cursor &c, std::vector<Rz_scanEntry> &entries)
+{
+    skipWhitespace(c);
+    if (c.byte() != '{')
+    {
+        return false;
+    }
+    skipWhitespace(c);
+    if (c.peek() == '}')
+    {
+        c.byte();
+        return c.ok;
+    }
+
+    while (c.ok)
+    {
+        skipWhitespace(c);
+        const std::size_t keyStart = c.pos;
+        if (!skipJsonString(c))
+        {
+            return false;
+        }
+        const std::string_view token = c.data.substr(keyStart, c.pos - keyStart);
+
+        Rz_scanEntry entry;
+        if (token.find('\\') == std::string_view::npos)
+        {
+            entry.key.assign(token.substr(1, token.size() - 2));
+        }
+        else
+        {
+            const auto key = nlohmann::json::parse(token, nullptr, false);
+            if (!key.is_string())
+            {
+                return false;
+            }
+            entry.key = key.get<std::string>();
+        }
+
+        skipWhitespace(c);
+        if (c.byte() != ':')
+        {
+            return false;
+        }
+        skipWhitespace(c);
+        entry.offset = c.pos;
+        entry.object = c.peek() == '{';
+        if (!skipJsonValue(c))
+        {
+            return false;
+        }
+        entry.size = c.pos - entry.offset;
+        entries.push_back(std::move(entry));
+
+        skipWhitespace(c);
+        const std::uint8_t separator = c.byte();
+        if (separator == '}')
+        {
+            return c.ok;
+        }
+        if (separator != ',')
+        {
+            return false;
+        }
+    }
+    return false;
+}
+} // namespace
+
+bool scanRecord(OutputFormat fmt, std::string_view data, std::vector<Rz_scanEntry> &entries)
+{
+    entries.clear();
+    Cursor cursor{data};
+
+    switch (fmt)
+    {
+    case OutputFormat::JSON:
+        return scanJson(cursor, entries);
+    case OutputFormat::BSON:
+        return scanBson(cursor, entries);
+    case OutputFormat::CBOR:
+        return scanCbor(cursor, entries);
+    case OutputFormat::MSGPACK:
+        return scanMsgpack(cursor, entries);
+    case OutputFormat::UBJSON:
+        return scanUbjson(cursor, false, entries);
+    case OutputFormat::BJDATA:
+        return scanUbjson(cursor, true, entries);
+    }
+    return false;
+}
+
+bool decodeScalar(OutputFormat fmt, std::string_view data, const Rz_scanEntry &entry, std::string &out)
+{
+    if (fmt == OutputFormat::BSON && entry.bsonType == 0x0A)
+    {
+        out = "null";
+        return true;
+    }
+    if (entry.object || entry.size == 0 || entry.offset > data.size() || entry.size > data.size() - entry.offset)
+    {
+        return false;
+    }
+    const std::string_view value = data.substr(entry.offset, entry.size);
+    const auto first = static_cast<std::uint8_t>(value.front());
+    Cursor c{value};
+
+    // strings, the common case, straight from the encoded bytes
+    switch (fmt)
+    {
+    case OutputFormat::JSON:
+        if (first != '"')
+        {
+            out.assign(value);
+            return first != '{' && first != '[';
+        }
+        if (value.size() >= 2 && value.find('\\') == std::string_view::npos)
+        {
+            out.assign(value.substr(1, value.size() - 2));
+            return true;
+        }
+        break;
+    case OutputFormat::BSON:
+    {
+        double number = 0;
+        switch (entry.bsonType)
+        {
+        case 0x02:
+        {
+            const std::uint64_t size = c.littleEndian(4);
+            if (!c.ok || size < 1 || size + 4 != value.size())
+            {
+                return false;
+            }
+            out.assign(value.substr(4, size - 1));
+            return true;
+        }
+        case 0x01:
+            std::memcpy(&number, value.data(), std::min(sizeof(number), value.size()));
+            out = nlohmann::json(number).dump();
+            return value.size() == 8;
+        case 0x08:
+            out = c.byte() != 0 ? "true" : "false";
+            return c.ok;
+        case 0x10:
+            out = std::to_string(static_cast<std::int32_t>(c.littleEndian(4)));
+            return c.ok;
+        case 0x11:
+            out = std::to_string(c.littleEndian(8));
+            return c.ok;
+        case 0x12:
+            out = std::to_string(static_cast<std::int64_t>(c.littleEndian(8)));
+            return c.ok;
+        default:
+            return false;
+        }
+    }
+    case OutputFormat::CBOR:
+        if ((first >> 5) == 3)
+        {
+            std::uint8_t major = 0;
+            std::uint64_t size = 0;
+            bool indefinite = false;
+            cborHeader(c, major, size, indefinite);
+            out.clear();
+            while (c.ok && indefinite && c.peek() != 0xFF)
+            {
+                bool chunked = false;
+                if (!cborHeader(c, major, size, chunked) || major != 3 || chunked || !c.has(size))
+                {
+                    return false;
+                }
+                out.append(value.substr(c.pos, size));
+                c.skip(size);
+            }
+            if (!indefinite && c.has(size))
+            {
+                out.assign(value.substr(c.pos, size));
+                return true;
+            }
+            return indefinite && c.byte() == 0xFF;
+        }
+        break;
+    case OutputFormat::MSGPACK:
+        if ((first >= 0xA0 && first <= 0xBF) || (first >= 0xD9 && first <= 0xDB))
+        {
+            return msgpackKey(c, out);
+        }
+        break;
+    case OutputFormat::UBJSON:
+    case OutputFormat::BJDATA:
+        if (first == 'S')
+        {
+            c.byte();
+            std::uint64_t size = 0;
+            if (!ubjsonInteger(c, c.byte(), fmt == OutputFormat::BJDATA, size) || !c.has(size))
+            {
+                return false;
+            }
+            out.assign(value.substr(c.pos, size));
+            return true;
+        }
+        if (first == 'C' && value.size() == 2)
+        {
+            out.assign(value.substr(1, 1));
+            return true;
+        }
+        break;
+    }
+
+    // escaped JSON strings and other scalars through the DOM decoder, they are small
+    const auto *begin = reinterpret_cast<const std::uint8_t *>(value.data());
+    const auto *end = begin + value.size();
+    nlohmann::json scalar;
+    switch (fmt)
+    {
+    case OutputFormat::JSON:
+        scalar = nlohmann::json::parse(value, nullptr, false);
+        break;
+    case OutputFormat::CBOR:
+        scalar = nlohmann::json::from_cbor(begin, end, true, false);
+        break;
+    case OutputFormat::MSGPACK:
+        scalar = nlohmann::json::from_msgpack(begin, end, true, false);
+        break;
+    case OutputFormat::UBJSON:
+        scalar = nlohmann::json::from_ubjson(begin, end, true, false);
+        break;
+    case OutputFormat::BJDATA:
+        scalar = nlohmann::json::from_bjdata(begin, end, true, false);
+        break;
+    default:
+        return false;
+    }
+    if (scalar.is_discarded() || scalar.is_structured())
+    {
+        return false;
+    }
+    out = scalar.is_string() ? scalar.get<std::string>() : scalar.dump();
+    return true;
+}
@@ -0,0 +1,764 @@
+/**
+ * @file rz_search_index.cpp
+ * @author ZHENG Robert (robert.hase-zheng.net)
+ * @brief inverted index of selected metadata fields, written alongside the export
+ * @version 0.1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2025 ZHENG Robert
+ *
+ */
+
+#include "includes/rz_search_index.hpp"
+#include "includes/rz_shared_output.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <iterator>
+#include <limits>
+#include <map>
+
+namespace
+{
+constexpr std::uint32_t version{1};
+constexpr std::size_t headerSize{56};
+constexpr std::size_t termEntrySize{24};
+constexpr std::size_t recordEntrySize{8};
+
+std::uint64_t readLe(const char *p, int bytes)
+{
+    std::uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i)
+    {
+        value |= static_cast<std::uint64_t>(static_cast<unsigned char>(p[i])) << (8 * i);
+    }
+    return value;
+}
+
+void appendLe(std::string &out, std::uint64_t value, int bytes)
+{
+    for (int i = 0; i < bytes; ++i)
+    {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+void appendVarint(std::string &out, std::uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+// an index file of a directory: the base (sequence 0) or a delta segment
+struct IndexFile
+{
+    std::uint64_t sequence;
+    std::string path;
+    std::uint64_t size;
+};
+
+// the index files of the directory, oldest first; files in flight are hidden
+std::vector<IndexFile> indexFiles(const std::string &directory)
+{
+    std::vector<IndexFile> files;
+    const std::string base(Rz_searchIndex::fileName);
+    std::error_code ec;
+    for (const auto &entry : std::filesystem::directory_iterator(directory, ec))
+    {
+        const std::string name = entry.path().filename().string();
+        std::uint64_t sequence = 0;
+        if (name != base)
+        {
+            if (name.size() <= base.size() + 1 || !name.starts_with(base) || name[base.size()] != '.')
+            {
+                continue;
+            }
+            const char *first = name.data() + base.size() + 1;
+            const char *last = name.data() + name.size();
+            const auto [end, error] = std::from_chars(first, last, sequence);
+            if (error != std::errc() || end != last || sequence == 0)
+            {
+                continue;
+            }
+        }
+        std::error_code sizeError;
+        const std::uint64_t size = entry.file_size(sizeError);
+        if (!sizeError)
+        {
+            files.push_back({sequence, entry.path().string(), size});
+        }
+    }
+    std::sort(files.begin(), files.end(), [](const IndexFile &a, const IndexFile &b) {
+        return a.sequence < b.sequence;
+    });
+    return files;
+}
+
+// the areas of a new index file; records are numbered in the order added, terms must
+// be added in ascending order. Offsets into the strings and sizes are 32-bit fields,
+// an index beyond them does not fit and is not written.
+class IndexBuilder
+{
+public:
+    std::uint32_t addRecord(std::string_view name)
+    {
+        fitsIn32(strings.size() + name.size());
+        fitsIn32(std::uint64_t{records} + 1);
+        appendLe(recordArea, strings.size(), 4);
+        appendLe(recordArea, name.size(), 4);
+        strings.append(name);
+        return records++;
+    }
+
+    void addTerm(std::string_view t, std::vector<std::uint32_t> &ids)
+    {
+        if (ids.empty())
+        {
+            return;
+        }
+        std::sort(ids.begin(), ids.end());
+        const std::size_t postingsOffset = postingArea.size();
+        std::uint32_t previous = 0;
+        for (const std::uint32_t id : ids)
+        {
+            appendVarint(postingArea, id - previous);
+            previous = id;
+        }
+        fitsIn32(strings.size() + t.size());
+        fitsIn32(postingArea.size() - postingsOffset);
+        fitsIn32(ids.size());
+        fitsIn32(std::uint64_t{terms} + 1);
+        appendLe(termArea, strings.size(), 4);
+        appendLe(termArea, t.size(), 4);
+        appendLe(termArea, postingsOffset, 8);
+        appendLe(termArea, postingArea.size() - postingsOffset, 4);
+        appendLe(termArea, ids.size(), 4);
+        strings.append(t);
+        ++terms;
+    }
+
+    bool fits() const { return fitting; }
+
+    /**
+     * @brief write
+     * @details writes and syncs the file under a name of its own next to path, the
+     * caller publishes it
+     * @return the name written, empty on error or if the index does not fit
+     */
+    std::string write(const std::string &path) const
+    {
+        if (!fitting)
+        {
+            return {};
+        }
+        const std::uint64_t recordsOffset = headerSize + termArea.size();
+        const std::uint64_t postingsOffset = recordsOffset + recordArea.size();
+        const std::uint64_t stringsOffset = postingsOffset + postingArea.size();
+        const std::uint64_t fileSize = stringsOffset + strings.size();
+        std::string header("RZIX", 4);
+        appendLe(header, version, 4);
+        appendLe(header, records, 4);
+        appendLe(header, terms, 4);
+        appendLe(header, headerSize, 8);
+        appendLe(header, recordsOffset, 8);
+        appendLe(header, postingsOffset, 8);
+        appendLe(header, stringsOffset, 8);
+        appendLe(header, fileSize, 8);
+
+        const std::string tmpPath = sharedTmpPath(path);
+        const int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        if (fd < 0)
+        {
+            return {};
+        }
+        bool ok = true;
+        const std::array<const std::string *, 5> areas{&header, &termArea, &recordArea, &postingArea, &strings};
+        for (const std::string *area : areas)
+        {
+            std::size_t done = 0;
+            while (ok && done < area->size())
+            {
+                const ssize_t n = ::write(fd, area->data() + done, area->size() - done);
+                ok = n > 0;
+                done += n > 0 ? static_cast<std::size_t>(n) : 0;
+            }
+        }
+        ok = fsync(fd) == 0 && ok;
+        ok = ::close(fd) == 0 && ok;
+        if (!ok)
+        {
+            std::remove(tmpPath.c_str());
+            return {};
+        }
+        return tmpPath;
+    }
+
+private:
+    std::string termArea;
+    std::string recordArea;
+    std::string postingArea;
+    std::string strings;
+    std::uint32_t records{0};
+    std::uint32_t terms{0};
+    bool fitting{true};
+
+    void fitsIn32(std::uint64_t value)
+    {
+        fitting = fitting && value <= std::numeric_limits<std::uint32_t>::max();
+    }
+};
+
+} // namespace
+
+// Rz_searchIndexFile -----------------------------------------------------------
+
+Rz_searchIndexFile::~Rz_searchIndexFile()
+{
+    close();
+}
+
+bool Rz_searchIndexFile::open(const std::string &path)
+{
+    close();
+
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < headerSize)
+    {
+        ::close(fd);
+        return false;
+    }
+    void *mapped = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED)
+    {
+        return false;
+    }
+    data = static_cast<const char *>(mapped);
+    size = static_cast<std::size_t>(st.st_size);
+
+    // the areas must lie in the file, in this order
+    const std::uint64_t records = recordCount();
+    const std::uint64_t terms = termCount();
+    const std::uint64_t termsOffset = readLe(data + 16, 8);
+    const std::uint64_t recordsOffset = readLe(data + 24, 8);
+    const std::uint64_t postingsOffset = readLe(data + 32, 8);
+    const std::uint64_t stringsOffset = readLe(data + 40, 8);
+    const bool valid = std::memcmp(data, "RZIX", 4) == 0 && readLe(data + 4, 4) == version
+                       && readLe(data + 48, 8) == size && termsOffset == headerSize
+                       && recordsOffset == termsOffset + terms * termEntrySize
+                       && postingsOffset == recordsOffset + records * recordEntrySize
+                       && postingsOffset <= stringsOffset && stringsOffset <= size;
+    if (!valid)
+    {
+        close();
+    }
+    return valid;
+}
+
+void Rz_searchIndexFile::close()
+{
+    if (data != nullptr)
+    {
+        munmap(const_cast<char *>(data), size);
+    }
+    data = nullptr;
+    size = 0;
+}
+
+std::uint32_t Rz_searchIndexFile::recordCount() const
+{
+    return data != nullptr ? static_cast<std::uint32_t>(readLe(data + 8, 4)) : 0;
+}
+
+std::uint32_t Rz_searchIndexFile::termCount() const
+{
+    return data != nullptr ? static_cast<std::uint32_t>(readLe(data + 12, 4)) : 0;
+}
+
+std::string_view Rz_searchIndexFile::recordName(std::uint32_t id) const
+{
+    if (id >= recordCount())
+    {
+        return {};
+    }
+    const char *entry = data + readLe(data + 24, 8) + id * recordEntrySize;
+    const std::uint64_t offset = readLe(data + 40, 8) + readLe(entry, 4);
+    const std::uint64_t length = readLe(entry + 4, 4);
+    if (offset + length > size)
+    {
+        return {};
+    }
+    return std::string_view(data + offset, length);
+}
+
+std::string_view Rz_searchIndexFile::term(std::uint32_t index) const
+{
+    if (index >= termCount())
+    {
+        return {};
+    }
+    const char *entry = data + headerSize + index * termEntrySize;
+    const std::uint64_t offset = readLe(data + 40, 8) + readLe(entry, 4);
+    const std::uint64_t length = readLe(entry + 4, 4);
+    if (offset + length > size)
+    {
+        return {};
+    }
+    return std::string_view(data + offset, length);
+}
+
+std::vector<std::uint32_t> Rz_searchIndexFile::postings(std::uint32_t index) const
+{
+    std::vector<std::uint32_t> ids;
+    if (index >= termCount())
+    {
+        return ids;
+    }
+    const char *entry = data + headerSize + index * termEntrySize;
+    std::uint64_t pos = readLe(data + 32, 8) + readLe(entry + 8, 8);
+    const std::uint64_t end = pos + readLe(entry + 16, 4);
+    if (end > size)
+    {
+        return ids;
+    }
+    ids.reserve(readLe(entry + 20, 4));
+
+    std::uint32_t id = 0;
+    while (pos < end)
+    {
+        std::uint32_t gap = 0;
+        int shift = 0;
+        unsigned char b = 0;
+        do
+        {
+            b = static_cast<unsigned char>(data[pos++]);
+            gap |= static_cast<std::uint32_t>(b & 0x7F) << shift;
+            shift += 7;
+        } while ((b & 0x80) != 0 && pos < end && shift < 35);
+        id += gap;
+        ids.push_back(id);
+    }
+    return ids;
+}
+
+std::optional<std::uint32_t> Rz_searchIndexFile::findTerm(std::string_view term) const
+{
+    std::uint32_t low = 0;
+    std::uint32_t high = termCount();
+    while (low < high)
+    {
+        const std::uint32_t mid = low + (high - low) / 2;
+        if (this->term(mid) < term)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    if (low < termCount() && this->term(low) == term)
+    {
+        return low;
+    }
+    return std::nullopt;
+}
+
+std::vector<std::uint32_t> Rz_searchIndexFile::lookup(std::string_view field, std::string_view token) const
+{
+    const auto index = findTerm(Rz_searchIndex::term(field, token));
+    return index ? postings(*index) : std::vector<std::uint32_t>{};
+}
+
+// Rz_searchIndexReader ---------------------------------------------------------
+
+bool Rz_searchIndexReader::open(const std::string &directory)
+{
+    std::vector<std::string> paths;
+    for (auto &file : indexFiles(directory))
+    {
+        paths.push_back(std::move(file.path));
+    }
+    return !paths.empty() && open(paths);
+}
+
+bool Rz_searchIndexReader::open(const std::vector<std::string> &paths)
+{
+    files.clear();
+    newest.clear();
+    for (const auto &path : paths)
+    {
+        files.push_back(std::make_unique<Rz_searchIndexFile>());
+        if (!files.back()->open(path))
+        {
+            files.clear();
+            return false;
+        }
+    }
+    // the oldest file holds whatever the newer ones don't
+    for (std::size_t f = 1; f < files.size(); ++f)
+    {
+        for (std::uint32_t id = 0; id < files[f]->recordCount(); ++id)
+        {
+            newest[files[f]->recordName(id)] = f;
+        }
+    }
+    return true;
+}
+
+bool Rz_searchIndexReader::isLive(std::size_t file, std::uint32_t id) const
+{
+    if (file + 1 == files.size())
+    {
+        return true;
+    }
+    const auto it = newest.find(files[file]->recordName(id));
+    return it == newest.end() || it->second == file;
+}
+
+std::vector<std::string> Rz_searchIndexReader::lookup(std::string_view field, std::string_view token) const
+{
+    return lookup(Rz_searchIndex::term(field, token));
+}
+
+std::vector<std::string> Rz_searchIndexReader::lookup(std::string_view t) const
+{
+    std::vector<std::string> names;
+    for (std::size_t f = 0; f < files.size(); ++f)
+    {
+        const auto index = files[f]->findTerm(t);
+        if (!index)
+        {
+            continue;
+        }
+        for (const std::uint32_t id : files[f]->postings(*index))
+        {
+            if (isLive(f, id))
+            {
+                names.emplace_back(files[f]->recordName(id));
+            }
+        }
+    }
+    std::sort(names.begin(), names.end());
+    names.erase(std::unique(names.begin(), names.end()), names.end());
+    return names;
+}
+
+// Rz_searchIndex ---------------------------------------------------------------
+
+std::shared_ptr<Rz_searchIndex> Rz_searchIndex::open(const std::string &directory)
+{
+    return openShared<Rz_searchIndex>(directory);
+}
+
+Rz_searchIndex::Rz_searchIndex(std::string directory)
+    : directory(std::move(directory))
+    , filePath(this->directory + "/" + std::string(fileName))
+{
+}
+
+Rz_searchIndex::~Rz_searchIndex()
+{
+    flush();
+}
+
+void Rz_searchIndex::tokenize(std::string_view value, std::vector<std::string> &tokens)
+{
+    std::string token;
+    for (const char c : value)
+    {
+        const auto b = static_cast<unsigned char>(c);
+        if ((b >= '0' && b <= '9') || (b >= 'a' && b <= 'z') || b >= 0x80)
+        {
+            token.push_back(c);
+        }
+        else if (b >= 'A' && b <= 'Z')
+        {
+            token.push_back(static_cast<char>(b - 'A' + 'a'));
+        }
+        else if (!token.empty())
+        {
+            tokens.push_back(std::move(token));
+            token.clear();
+        }
+    }
+    if (!token.empty())
+    {
+        tokens.push_back(std::move(token));
+    }
+}
+
+std::string Rz_searchIndex::term(std::string_view field, std::string_view token)
+{
+    std::string t;
+    t.reserve(field.size() + 1 + token.size());
+    t.append(field);
+    t.push_back('\0');
+    t.append(token);
+    return t;
+}
+
+bool Rz_searchIndex::add(std::string_view name, const std::vector<Field> &fields)
+{
+    std::vector<std::string> tokens;
+    std::vector<std::string> terms;
+    for (const auto &[field, value] : fields)
+    {
+        tokens.clear();
+        tokenize(value, tokens);
+        for (const auto &token : tokens)
+        {
+            terms.push_back(term(field, token));
+        }
+    }
+    std::sort(terms.begin(), terms.end());
+    terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+
+    std::lock_guard lock(mutex);
+    pending[std::string(name)] = std::move(terms);
+
+    return pending.size() < flushThreshold || flushLocked();
+}
+
+std::vector<std::string> Rz_searchIndex::search(const std::vector<std::vector<std::string>> &query)
+{
+    std::vector<std::string> names;
+    std::lock_guard lock(mutex);
+    Rz_searchIndexReader index;
+    const bool written = index.open(directory);
+    for (std::size_t q = 0; q < query.size(); ++q)
+    {
+        const auto &terms = query[q];
+        std::vector<std::string> matches;
+        for (const auto &t : terms)
+        {
+            if (!written)
+            {
+                break;
+            }
+            for (auto &name : index.lookup(t))
+            {
+                // a collected record supersedes its entries in the files
+                if (!pending.contains(name))
+                {
+                    matches.push_back(std::move(name));
+                }
+            }
+        }
+        for (const auto &[name, recordTerms] : pending)
+        {
+            if (std::any_of(terms.begin(), terms.end(), [&recordTerms](const std::string &t) {
+                    return std::binary_search(recordTerms.begin(), recordTerms.end(), t);
+                }))
+            {
+                matches.push_back(name);
+            }
+        }
+        std::sort(matches.begin(), matches.end());
+        matches.erase(std::unique(matches.begin(), matches.end()), matches.end());
+
+        if (q == 0)
+        {
+            names = std::move(matches);
+            continue;
+        }
+        std::vector<std::string> both;
+        std::set_intersection(names.begin(), names.end(), matches.begin(), matches.end(), std::back_inserter(both));
+        names = std::move(both);
+    }
+    return names;
+}
+
+bool Rz_searchIndex::flush()
+{
+    std::lock_guard lock(mutex);
+    return flushLocked();
+}
+
+bool Rz_searchIndex::flushLocked()
+{
+    if (pending.empty())
+    {
+        return true;
+    }
+    if (!writeSegment())
+    {
+        return false;
+    }
+    pending.clear();
+    return mergeSegments();
+}
+
+/**
+ * @brief Rz_searchIndex::writeSegment
+ * @details writes the collected records as the newest segment; the number is taken
+ * with link(), a segment of another process is never replaced
+ */
+bool Rz_searchIndex::writeSegment()
+{
+    // postings of the collected records, sorted by term
+    IndexBuilder builder;
+    std::map<std::string_view, std::vector<std::uint32_t>> postings;
+    for (const auto &[name, terms] : pending)
+    {
+        const std::uint32_t id = builder.addRecord(name);
+        for (const auto &t : terms)
+        {
+            postings[t].push_back(id);
+        }
+    }
+    for (auto &[t, ids] : postings)
+    {
+        builder.addTerm(t, ids);
+    }
+
+    const std::string tmpPath = builder.write(filePath);
+    if (tmpPath.empty())
+    {
+        return false;
+    }
+    const auto files = indexFiles(directory);
+    std::uint64_t sequence = files.empty() ? 1 : files.back().sequence + 1;
+    bool ok = false;
+    while (true)
+    {
+        const std::string path = std::format("{}.{}", filePath, sequence++);
+        ok = ::link(tmpPath.c_str(), path.c_str()) == 0;
+        if (ok || errno != EEXIST)
+        {
+            break;
+        }
+    }
+    std::remove(tmpPath.c_str());
+    return ok;
+}
+
+/**
+ * @brief Rz_searchIndex::mergeSegments
+ * @details merges the newest files while the next older one is less than mergeRatio
+ * times their size; the result replaces the newest of them, or the base once it is
+ * included. The merged files are removed afterwards: until then they hold the same
+ * records as the result, readers see the same index either way.
+ */
+bool Rz_searchIndex::mergeSegments()
+{
+    const auto files = indexFiles(directory);
+    if (files.size() < 2)
+    {
+        return true;
+    }
+    std::size_t first = files.size() - 1;
+    std::uint64_t bytes = files.back().size;
+    while (first > 0 && files[first - 1].size < mergeRatio * bytes)
+    {
+        bytes += files[--first].size;
+    }
+    if (first + 1 == files.size())
+    {
+        return true;
+    }
+
+    std::vector<std::string> paths;
+    for (std::size_t f = first; f < files.size(); ++f)
+    {
+        paths.push_back(files[f].path);
+    }
+    Rz_searchIndexReader merged;
+    if (!merged.open(paths))
+    {
+        return false;
+    }
+
+    // the live records of each file, renumbered
+    constexpr std::uint32_t stale = std::numeric_limits<std::uint32_t>::max();
+    IndexBuilder builder;
+    std::vector<std::vector<std::uint32_t>> renumbered(merged.fileCount());
+    for (std::size_t f = 0; f < merged.fileCount(); ++f)
+    {
+        const auto &file = merged.file(f);
+        renumbered[f].assign(file.recordCount(), stale);
+        for (std::uint32_t id = 0; id < file.recordCount(); ++id)
+        {
+            if (merged.isLive(f, id))
+            {
+                renumbered[f][id] = builder.addRecord(file.recordName(id));
+            }
+        }
+    }
+
+    // the terms of all files in order, each with the live postings of every file
+    std::vector<std::uint32_t> next(merged.fileCount(), 0);
+    std::vector<std::uint32_t> ids;
+    while (true)
+    {
+        std::optional<std::string_view> t;
+        for (std::size_t f = 0; f < merged.fileCount(); ++f)
+        {
+            if (next[f] < merged.file(f).termCount() && (!t || merged.file(f).term(next[f]) < *t))
+            {
+                t = merged.file(f).term(next[f]);
+            }
+        }
+        if (!t)
+        {
+            break;
+        }
+        ids.clear();
+        for (std::size_t f = 0; f < merged.fileCount(); ++f)
+        {
+            if (next[f] < merged.file(f).termCount() && merged.file(f).term(next[f]) == *t)
+            {
+                for (const std::uint32_t id : merged.file(f).postings(next[f]))
+                {
+                    if (id < renumbered[f].size() && renumbered[f][id] != stale)
+                    {
+                        ids.push_back(renumbered[f][id]);
+                    }
+                }
+                ++next[f];
+            }
+        }
+        builder.addTerm(*t, ids);
+    }
+    if (!builder.fits())
+    {
+        // the merged index would exceed the 32-bit fields: the files stay as they are
+        return true;
+    }
+
+    const std::string &target = first == 0 ? filePath : files.back().path;
+    const std::string tmpPath = builder.write(target);
+    std::string error;
+    if (tmpPath.empty() || !publishFile(tmpPath, target, error))
+    {
+        return false;
+    }
+    for (const auto &path : paths)
+    {
+        if (path != target)
+        {
+            std::remove(path.c_str());
+        }
+    }
+    return true;
+}
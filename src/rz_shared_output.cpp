@@ -0,0 +1,141 @@
+/**
+ * @file rz_shared_output.cpp
+ * @author ZHENG Robert (robert.hase-zheng.net)
+ * @brief output files shared by several export processes
+ * @version 0.1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2025 ZHENG Robert
+ *
+ */
+
+#include "includes/rz_shared_output.hpp"
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <format>
+
+namespace
+{
+std::atomic<std::uint64_t> tmpCounter{0};
+} // namespace
+
+std::string sharedTmpPath(const std::string &path)
+{
+    const std::size_t slash = path.rfind('/');
+    const std::size_t nameStart = slash == std::string::npos ? 0 : slash + 1;
+    return std::format("{}.{}.{}.{}.tmp",
+                       path.substr(0, nameStart),
+                       path.substr(nameStart),
+                       static_cast<long>(::getpid()),
+                       tmpCounter.fetch_add(1, std::memory_order_relaxed));
+}
+
+bool publishFile(const std::string &tmpPath, const std::string &path, std::string &error)
+{
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0)
+    {
+        error = std::format("{}: {}", path, std::strerror(errno));
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool writeShared(const std::string &path, std::string_view data, std::string &error)
+{
+    const std::string tmpPath = sharedTmpPath(path);
+    const int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        error = std::format("{}: {}", tmpPath, std::strerror(errno));
+        return false;
+    }
+    const char *p = data.data();
+    std::size_t left = data.size();
+    bool ok = true;
+    while (left > 0 && ok)
+    {
+        const ssize_t n = ::write(fd, p, left);
+        ok = n > 0;
+        if (ok)
+        {
+            p += n;
+            left -= static_cast<std::size_t>(n);
+        }
+    }
+    // on disk before the rename: after a crash the name holds the old or the new file
+    ok = ok && ::fsync(fd) == 0;
+    if (!ok || ::close(fd) != 0)
+    {
+        error = std::format("{}: {}", tmpPath, std::strerror(errno));
+        if (!ok)
+        {
+            ::close(fd);
+        }
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    return publishFile(tmpPath, path, error);
+}
+
+bool createDirectoriesShared(const std::string &path, std::string &error)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(path, ec);
+    // another process may have created a part of the path between our checks
+    if (std::filesystem::is_directory(path))
+    {
+        return true;
+    }
+    error = std::format("{}: {}", path, ec ? ec.message() : std::string("not a directory"));
+    return false;
+}
+
+bool lockFile(int fd, int operation)
+{
+    int rc;
+    do
+    {
+        rc = ::flock(fd, operation);
+    } while (rc != 0 && errno == EINTR);
+    return rc == 0;
+}
+
+int lockOutput(const std::string &path, std::string &error)
+{
+    while (true)
+    {
+        const int fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+        if (fd < 0)
+        {
+            error = std::format("{}: {}", path, std::strerror(errno));
+            return -1;
+        }
+        if (!lockFile(fd, LOCK_EX))
+        {
+            error = std::format("{}: {}", path, std::strerror(errno));
+            ::close(fd);
+            return -1;
+        }
+
+        // the previous holder may have renamed a new file into place
+        struct stat locked{};
+        struct stat current{};
+        if (fstat(fd, &locked) == 0 && ::stat(path.c_str(), &current) == 0 && locked.st_dev == current.st_dev
+            && locked.st_ino == current.st_ino)
+        {
+            return fd;
+        }
+        ::close(fd);
+    }
+}
@@ -0,0 +1,617 @@
+/**
+ * @file rz_stream_encoder.cpp
+ * @author ZHENG Robert (robert.hase-zheng.net)
+ * @brief chunked streaming encoder for JSON, BSON, CBOR, MessagePack, UBJSON and BJData
+ * @version 0.1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2025 ZHENG Robert
+ *
+ */
+
+#include "includes/rz_stream_encoder.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+constexpr std::size_t bufferSize{Rz_streamEncoder::chunkSize};
+
+char32_t nextCodePoint(std::u16string_view s, std::size_t &i)
+{
+    const char16_t c = s[i++];
+    if (c >= 0xD800 && c <= 0xDBFF && i < s.size() && s[i] >= 0xDC00 && s[i] <= 0xDFFF)
+    {
+        return 0x10000 + ((static_cast<char32_t>(c) - 0xD800) << 10)
+               + (static_cast<char32_t>(s[i++]) - 0xDC00);
+    }
+    if (c >= 0xD800 && c <= 0xDFFF)
+    {
+        // lone surrogate, replaced like QString::toUtf8() does
+        return 0xFFFD;
+    }
+    return c;
+}
+
+// expects valid UTF-8
+char32_t nextCodePoint(std::string_view s, std::size_t &i)
+{
+    const auto c = static_cast<unsigned char>(s[i++]);
+    if (c < 0x80)
+    {
+        return c;
+    }
+    int extra = c >= 0xF0 ? 3 : (c >= 0xE0 ? 2 : 1);
+    char32_t cp = c & (0x3F >> extra);
+    while (extra-- > 0 && i < s.size())
+    {
+        cp = (cp << 6) | (static_cast<unsigned char>(s[i++]) & 0x3F);
+    }
+    return cp;
+}
+
+std::size_t utf8Length(char32_t cp)
+{
+    return cp < 0x80 ? 1 : (cp < 0x800 ? 2 : (cp < 0x10000 ? 3 : 4));
+}
+
+std::size_t encodeUtf8(char32_t cp, char *out)
+{
+    if (cp < 0x80)
+    {
+        out[0] = static_cast<char>(cp);
+        return 1;
+    }
+    if (cp < 0x800)
+    {
+        out[0] = static_cast<char>(0xC0 | (cp >> 6));
+        out[1] = static_cast<char>(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    if (cp < 0x10000)
+    {
+        out[0] = static_cast<char>(0xE0 | (cp >> 12));
+        out[1] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out[2] = static_cast<char>(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    out[0] = static_cast<char>(0xF0 | (cp >> 18));
+    out[1] = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+    out[2] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+    out[3] = static_cast<char>(0x80 | (cp & 0x3F));
+    return 4;
+}
+} // namespace
+
+Rz_streamEncoder::Rz_streamEncoder(OutputFormat fmt, Rz_byteSink &sink)
+    : format(fmt)
+    , sink(sink)
+    , buffer(std::make_unique<char[]>(bufferSize))
+    , scratch(std::make_unique<char[]>(chunkSize))
+{}
+
+bool Rz_streamEncoder::less(const Rz_text &lhs, const Rz_text &rhs)
+{
+    return std::visit(
+        [](auto l, auto r) {
+            std::size_t i = 0;
+            std::size_t j = 0;
+            while (i < l.size() && j < r.size())
+            {
+                const char32_t a = nextCodePoint(l, i);
+                const char32_t b = nextCodePoint(r, j);
+                if (a != b)
+                {
+                    return a < b;
+                }
+            }
+            return i >= l.size() && j < r.size();
+        },
+        lhs,
+        rhs);
+}
+
+std::size_t Rz_streamEncoder::utf8Size(const Rz_text &text)
+{
+    if (const auto *u8 = std::get_if<std::string_view>(&text))
+    {
+        return u8->size();
+    }
+    const auto u16 = std::get<std::u16string_view>(text);
+    std::size_t size = 0;
+    for (std::size_t i = 0; i < u16.size();)
+    {
+        size += utf8Length(nextCodePoint(u16, i));
+    }
+    return size;
+}
+
+void Rz_streamEncoder::appendUtf8(std::string &out, const Rz_text &text)
+{
+    if (const auto *u8 = std::get_if<std::string_view>(&text))
+    {
+        out.append(*u8);
+        return;
+    }
+    const auto u16 = std::get<std::u16string_view>(text);
+    std::size_t pos = out.size();
+    out.resize(pos + utf8Size(text));
+    for (std::size_t i = 0; i < u16.size();)
+    {
+        pos += encodeUtf8(nextCodePoint(u16, i), out.data() + pos);
+    }
+}
+
+bool Rz_streamEncoder::encode(const std::vector<Node> &root)
+{
+    switch (format)
+    {
+    case OutputFormat::JSON:
+        writeJson(root);
+        break;
+    case OutputFormat::CBOR:
+        writeCbor(root);
+        break;
+    case OutputFormat::MSGPACK:
+        writeMsgpack(root);
+        break;
+    case OutputFormat::UBJSON:
+    case OutputFormat::BJDATA:
+        writeUbjson(root);
+        break;
+    case OutputFormat::BSON:
+        if (bsonSize(root) > static_cast<std::uint64_t>(std::numeric_limits<std::int32_t>::max()))
+        {
+            ok = false;
+            break;
+        }
+        writeBson(root);
+        break;
+    }
+    return ok;
+}
+
+bool Rz_streamEncoder::write(const char *data, std::size_t size)
+{
+    put(data, size);
+    return ok;
+}
+
+bool Rz_streamEncoder::flush()
+{
+    if (ok && used > 0)
+    {
+        ok = sink.write(buffer.get(), used);
+    }
+    used = 0;
+    return ok;
+}
+
+void Rz_streamEncoder::put(const char *data, std::size_t size)
+{
+    if (!ok || size == 0)
+    {
+        return;
+    }
+    if (used + size > bufferSize)
+    {
+        flush();
+        if (size >= bufferSize)
+        {
+            // large chunk: bypass the buffer
+            ok = ok && sink.write(data, size);
+            return;
+        }
+    }
+    std::memcpy(buffer.get() + used, data, size);
+    used += size;
+}
+
+void Rz_streamEncoder::put(char c)
+{
+    put(&c, 1);
+}
+
+void Rz_streamEncoder::putBigEndian(std::uint64_t value, int bytes)
+{
+    char out[8];
+    for (int i = 0; i < bytes; ++i)
+    {
+        out[i] = static_cast<char>(value >> (8 * (bytes - 1 - i)));
+    }
+    put(out, bytes);
+}
+
+void Rz_streamEncoder::putLittleEndian(std::uint64_t value, int bytes)
+{
+    char out[8];
+    for (int i = 0; i < bytes; ++i)
+    {
+        out[i] = static_cast<char>(value >> (8 * i));
+    }
+    put(out, bytes);
+}
+
+/**
+ * @brief Rz_streamEncoder::forEachChunk
+ * @details calls fn(data, size) with UTF-8 chunks of at most chunkSize bytes,
+ * each chunk of valid UTF-8 ends on a code point boundary
+ */
+template <typename Fn>
+void Rz_streamEncoder::forEachChunk(const Rz_text &text, Fn &&fn)
+{
+    if (const auto *u8 = std::get_if<std::string_view>(&text))
+    {
+        std::size_t pos = 0;
+        while (pos < u8->size())
+        {
+            std::size_t end = std::min(pos + chunkSize, u8->size());
+            while (end < u8->size() && end > pos
+                   && (static_cast<unsigned char>((*u8)[end]) & 0xC0) == 0x80)
+            {
+                --end;
+            }
+            // no lead byte within the chunk (invalid UTF-8): cut at the chunk size
+            if (end == pos)
+            {
+                end = std::min(pos + chunkSize, u8->size());
+            }
+            fn(u8->data() + pos, end - pos);
+            pos = end;
+        }
+        return;
+    }
+
+    const auto u16 = std::get<std::u16string_view>(text);
+    std::size_t fill = 0;
+    for (std::size_t i = 0; i < u16.size();)
+    {
+        if (fill + 4 > chunkSize)
+        {
+            fn(scratch.get(), fill);
+            fill = 0;
+        }
+        fill += encodeUtf8(nextCodePoint(u16, i), scratch.get() + fill);
+    }
+    if (fill > 0)
+    {
+        fn(scratch.get(), fill);
+    }
+}
+
+// JSON ---------------------------------------------------------------------
+
+void Rz_streamEncoder::writeJson(const std::vector<Node> &nodes)
+{
+    put('{');
+    bool first = true;
+    for (const auto &node : nodes)
+    {
+        if (!first)
+        {
+            put(',');
+        }
+        first = false;
+        writeJsonText(node.key);
+        put(':');
+        if (node.children)
+        {
+            writeJson(*node.children);
+        }
+        else
+        {
+            writeJsonText(node.value);
+        }
+    }
+    put('}');
+}
+
+void Rz_streamEncoder::writeJsonText(const Rz_text &text)
+{
+    static constexpr char hex[] = "0123456789abcdef";
+
+    put('"');
+    forEachChunk(text, [this](const char *data, std::size_t size) {
+        std::size_t run = 0;
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            const auto c = static_cast<unsigned char>(data[i]);
+            if (c >= 0x20 && c != '"' && c != '\\')
+            {
+                continue;
+            }
+            put(data + run, i - run);
+            run = i + 1;
+            switch (c)
+            {
+            case '"':
+                put("\\\"", 2);
+                break;
+            case '\\':
+                put("\\\\", 2);
+                break;
+            case '\b':
+                put("\\b", 2);
+                break;
+            case '\f':
+                put("\\f", 2);
+                break;
+            case '\n':
+                put("\\n", 2);
+                break;
+            case '\r':
+                put("\\r", 2);
+                break;
+            case '\t':
+                put("\\t", 2);
+                break;
+            default:
+            {
+                const char esc[6]{'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0x0F]};
+                put(esc, sizeof(esc));
+                break;
+            }
+            }
+        }
+        put(data + run, size - run);
+    });
+    put('"');
+}
+
+// CBOR ---------------------------------------------------------------------
+
+void Rz_streamEncoder::writeCborHeader(std::uint8_t major, std::uint64_t value)
+{
+    const auto type = static_cast<std::uint8_t>(major << 5);
+    if (value <= 23)
+    {
+        put(static_cast<char>(type | value));
+    }
+    else if (value <= 0xFF)
+    {
+        put(static_cast<char>(type | 24));
+        putBigEndian(value, 1);
+    }
+    else if (value <= 0xFFFF)
+    {
+        put(static_cast<char>(type | 25));
+        putBigEndian(value, 2);
+    }
+    else if (value <= 0xFFFFFFFF)
+    {
+        put(static_cast<char>(type | 26));
+        putBigEndian(value, 4);
+    }
+    else
+    {
+        put(static_cast<char>(type | 27));
+        putBigEndian(value, 8);
+    }
+}
+
+void Rz_streamEncoder::writeCbor(const std::vector<Node> &nodes)
+{
+    writeCborHeader(5, nodes.size());
+    for (const auto &node : nodes)
+    {
+        writeCborText(node.key);
+        if (node.children)
+        {
+            writeCbor(*node.children);
+        }
+        else
+        {
+            writeCborText(node.value);
+        }
+    }
+}
+
+void Rz_streamEncoder::writeCborText(const Rz_text &text)
+{
+    const std::size_t size = utf8Size(text);
+    if (size <= chunkSize)
+    {
+        writeCborHeader(3, size);
+        forEachChunk(text, [this](const char *data, std::size_t n) { put(data, n); });
+        return;
+    }
+
+    // indefinite-length text string, one definite chunk per buffer
+    put(static_cast<char>(0x7F));
+    forEachChunk(text, [this](const char *data, std::size_t n) {
+        writeCborHeader(3, n);
+        put(data, n);
+    });
+    put(static_cast<char>(0xFF));
+}
+
+// MessagePack ----------------------------------------------------------------
+
+void Rz_streamEncoder::writeMsgpack(const std::vector<Node> &nodes)
+{
+    const std::uint64_t count = nodes.size();
+    if (count <= 15)
+    {
+        put(static_cast<char>(0x80 | count));
+    }
+    else if (count <= 0xFFFF)
+    {
+        put(static_cast<char>(0xDE));
+        putBigEndian(count, 2);
+    }
+    else if (count <= 0xFFFFFFFF)
+    {
+        put(static_cast<char>(0xDF));
+        putBigEndian(count, 4);
+    }
+    else
+    {
+        ok = false;
+        return;
+    }
+
+    for (const auto &node : nodes)
+    {
+        writeMsgpackText(node.key);
+        if (node.children)
+        {
+            writeMsgpack(*node.children);
+        }
+        else
+        {
+            writeMsgpackText(node.value);
+        }
+    }
+}
+
+void Rz_streamEncoder::writeMsgpackText(const Rz_text &text)
+{
+    const std::uint64_t size = utf8Size(text);
+    if (size <= 31)
+    {
+        put(static_cast<char>(0xA0 | size));
+    }
+    else if (size <= 0xFF)
+    {
+        put(static_cast<char>(0xD9));
+        putBigEndian(size, 1);
+    }
+    else if (size <= 0xFFFF)
+    {
+        put(static_cast<char>(0xDA));
+        putBigEndian(size, 2);
+    }
+    else if (size <= 0xFFFFFFFF)
+    {
+        put(static_cast<char>(0xDB));
+        putBigEndian(size, 4);
+    }
+    else
+    {
+        ok = false;
+        return;
+    }
+    forEachChunk(text, [this](const char *data, std::size_t n) { put(data, n); });
+}
+
+// UBJSON / BJData ------------------------------------------------------------
+
+void Rz_streamEncoder::writeUbjsonSize(std::uint64_t value)
+{
+    const bool bjdata = format == OutputFormat::BJDATA;
+    auto number = [this, bjdata](char prefix, std::uint64_t n, int bytes) {
+        put(prefix);
+        if (bjdata)
+        {
+            putLittleEndian(n, bytes);
+        }
+        else
+        {
+            putBigEndian(n, bytes);
+        }
+    };
+
+    if (value <= 0x7F)
+    {
+        number('i', value, 1);
+    }
+    else if (value <= 0xFF)
+    {
+        number('U', value, 1);
+    }
+    else if (value <= 0x7FFF)
+    {
+        number('I', value, 2);
+    }
+    else if (bjdata && value <= 0xFFFF)
+    {
+        number('u', value, 2);
+    }
+    else if (value <= 0x7FFFFFFF)
+    {
+        number('l', value, 4);
+    }
+    else if (bjdata && value <= 0xFFFFFFFF)
+    {
+        number('m', value, 4);
+    }
+    else
+    {
+        number('L', value, 8);
+    }
+}
+
+void Rz_streamEncoder::writeUbjson(const std::vector<Node> &nodes)
+{
+    auto bytes = [this](const char *data, std::size_t n) { put(data, n); };
+
+    put('{');
+    for (const auto &node : nodes)
+    {
+        writeUbjsonSize(utf8Size(node.key));
+        forEachChunk(node.key, bytes);
+        if (node.children)
+        {
+            writeUbjson(*node.children);
+        }
+        else
+        {
+            put('S');
+            writeUbjsonSize(utf8Size(node.value));
+            forEachChunk(node.value, bytes);
+        }
+    }
+    put('}');
+}
+
+// BSON ---------------------------------------------------------------------
+
+std::uint64_t Rz_streamEncoder::bsonSize(const std::vector<Node> &nodes)
+{
+    std::uint64_t size = 4 + 1;
+    for (const auto &node : nodes)
+    {
+        size += 1 + utf8Size(node.key) + 1;
+        size += node.children ? bsonSize(*node.children) : 4 + utf8Size(node.value) + 1;
+    }
+    return size;
+}
+
+void Rz_streamEncoder::writeBson(const std::vector<Node> &nodes)
+{
+    putLittleEndian(bsonSize(nodes), 4);
+    for (const auto &node : nodes)
+    {
+        if (node.children)
+        {
+            put(static_cast<char>(0x03));
+            writeBsonCString(node.key);
+            writeBson(*node.children);
+        }
+        else
+        {
+            put(static_cast<char>(0x02));
+            writeBsonCString(node.key);
+            putLittleEndian(utf8Size(node.value) + 1, 4);
+            forEachChunk(node.value, [this](const char *data, std::size_t n) { put(data, n); });
+            put('\0');
+        }
+    }
+    put('\0');
+}
+
+void Rz_streamEncoder::writeBsonCString(const Rz_text &text)
+{
+    forEachChunk(text, [this](const char *data, std::size_t n) {
+        if (std::memchr(data, '\0', n) != nullptr)
+        {
+            // BSON keys must not contain U+0000
+            ok = false;
+            return;
+        }
+        put(data, n);
+    });
+    put('\0');
+}
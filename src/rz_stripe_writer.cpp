@@ -0,0 +1,149 @@
+/**
+ * @file rz_stripe_writer.cpp
+ * @author ZHENG Robert (robert.hase-zheng.net)
+ * @brief output striped over several roots, one writer queue per root
+ * @version 0.1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2025 ZHENG Robert
+ *
+ */
+
+#include "includes/rz_stripe_writer.hpp"
+#include "includes/rz_shared_output.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <format>
+
+namespace
+{
+bool writeFile(const std::string &path, const std::string &data, std::string &error)
+{
+    const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        error = std::format("{}: {}", path, std::strerror(errno));
+        return false;
+    }
+    const char *p = data.data();
+    std::size_t left = data.size();
+    while (left > 0)
+    {
+        const ssize_t n = ::write(fd, p, left);
+        if (n <= 0)
+        {
+            error = std::format("{}: {}", path, std::strerror(errno));
+            ::close(fd);
+            return false;
+        }
+        p += n;
+        left -= static_cast<std::size_t>(n);
+    }
+    if (::close(fd) != 0)
+    {
+        error = std::format("{}: {}", path, std::strerror(errno));
+        return false;
+    }
+    return true;
+}
+} // namespace
+
+std::shared_ptr<Rz_stripeWriter> Rz_stripeWriter::open(const std::string &root)
+{
+    return openShared<Rz_stripeWriter>(root);
+}
+
+std::size_t Rz_stripeWriter::stripeOf(std::string_view fileBasename, std::size_t stripes)
+{
+    std::uint64_t hash = 14695981039346656037ULL;
+    for (const char c : fileBasename)
+    {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+    }
+    return stripes > 0 ? static_cast<std::size_t>(hash % stripes) : 0;
+}
+
+Rz_stripeWriter::Rz_stripeWriter(std::string root)
+    : root(std::move(root))
+{
+    std::string error;
+    createDirectoriesShared(this->root, error);
+    worker = std::thread(&Rz_stripeWriter::run, this);
+}
+
+Rz_stripeWriter::~Rz_stripeWriter()
+{
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    worker.join();
+}
+
+void Rz_stripeWriter::enqueue(std::string fileName,
+                              std::string data,
+                              const std::shared_ptr<Batch> &batch,
+                              bool shared)
+{
+    std::unique_lock lock(mutex);
+    // a single file larger than the limit is accepted into an empty queue
+    changed.wait(lock, [this, &data] {
+        return pendingBytes == 0 || pendingBytes + data.size() <= maxPendingBytes;
+    });
+    pendingBytes += data.size();
+    ++batch->pending;
+    jobs.push_back({std::move(fileName), std::move(data), shared, batch});
+    lock.unlock();
+    changed.notify_all();
+}
+
+bool Rz_stripeWriter::drain(Batch &batch, std::vector<std::string> &failed, std::string &error)
+{
+    std::unique_lock lock(mutex);
+    changed.wait(lock, [&batch] { return batch.pending == 0; });
+    const bool ok = batch.failed.empty();
+    if (!ok)
+    {
+        error = std::format("{} failed writes, last: {}", batch.failed.size(), batch.lastError);
+    }
+    failed = std::move(batch.failed);
+    batch.failed.clear();
+    batch.lastError.clear();
+    return ok;
+}
+
+void Rz_stripeWriter::run()
+{
+    std::unique_lock lock(mutex);
+    while (true)
+    {
+        changed.wait(lock, [this] { return stopping || !jobs.empty(); });
+        if (jobs.empty())
+        {
+            return;
+        }
+        Job job = std::move(jobs.front());
+        jobs.pop_front();
+        lock.unlock();
+
+        std::string error;
+        const std::string path = root + "/" + job.fileName;
+        const bool ok = job.shared ? writeShared(path, job.data, error) : writeFile(path, job.data, error);
+
+        lock.lock();
+        pendingBytes -= job.data.size();
+        --job.batch->pending;
+        if (!ok)
+        {
+            job.batch->failed.push_back(std::move(job.fileName));
+            job.batch->lastError = std::move(error);
+        }
+        changed.notify_all();
+    }
+}
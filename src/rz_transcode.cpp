@@ -0,0 +1,427 @@
+/**
+ * @file rz_transcode.cpp
+ * @author ZHENG Robert (robert.hase-zheng.net)
+ * @brief convert directory trees of exported records between the supported formats
+ * @version 0.1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2025 ZHENG Robert
+ *
+ * usage: rz_transcode [--jobs N] [--batch N] [--resume] <source dir> <target dir> <format>
+ * format: JSON, BSON, CBOR, MSGPACK, UBJSON, BJDATA
+ *
+ */
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "includes/rz_config.hpp"
+#include "includes/rz_record_codec.hpp"
+#include "includes/rz_shared_output.hpp"
+
+namespace
+{
+constexpr char journalName[] = ".rz_transcode.journal";
+
+// upper limit of encoded bytes kept per worker before the batch is written
+constexpr std::size_t maxBatchBytes{64 * 1024 * 1024};
+
+// journalled files are kept as FNV-1a hashes of their relative path, 8 bytes each
+std::uint64_t pathHash(const QString &relative)
+{
+    std::uint64_t hash = 14695981039346656037ULL;
+    for (const char c : relative.toUtf8())
+    {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+struct Job
+{
+    QString source;
+    QString relative;
+    OutputFormat sourceFormat;
+};
+
+struct Output
+{
+    QString path;
+    std::string data;
+};
+
+/**
+ * @brief The Rz_transcoder class
+ * @details workers pull batches of files from a shared directory listing, read them
+ * through mmap, decode and re-encode them with the plugin codecs and write the batch.
+ * Each output is written under a name of its own and renamed into place, the batch is
+ * synced once afterwards. Finished files are then appended to a journal in the target
+ * directory, --resume skips them without touching the already written outputs.
+ */
+class Rz_transcoder
+{
+public:
+    Rz_transcoder(const QString &sourceDir,
+                  const QString &targetDir,
+                  OutputFormat target,
+                  int batchSize)
+        : sourceDir(QDir(sourceDir).absolutePath())
+        , targetDir(QDir(targetDir).absolutePath())
+        , target(target)
+        , batchSize(batchSize)
+        , directories{this->sourceDir}
+    {}
+
+    bool openJournal(bool resume)
+    {
+        if (!QDir().mkpath(targetDir))
+        {
+            return false;
+        }
+        journal.setFileName(targetDir + "/" + journalName);
+        if (resume && journal.open(QIODevice::ReadOnly))
+        {
+            while (!journal.atEnd())
+            {
+                const QString line = QString::fromUtf8(journal.readLine()).trimmed();
+                if (!line.isEmpty())
+                {
+                    done.push_back(pathHash(line));
+                }
+            }
+            journal.close();
+            std::sort(done.begin(), done.end());
+        }
+        const QIODevice::OpenMode mode = resume ? QIODevice::Append : QIODevice::Truncate;
+        return journal.open(QIODevice::WriteOnly | mode);
+    }
+
+    void run(int jobs)
+    {
+        std::vector<std::jthread> workers;
+        workers.reserve(jobs);
+        for (int i = 0; i < jobs; ++i)
+        {
+            workers.emplace_back([this] { work(); });
+        }
+    }
+
+    std::atomic<std::uint64_t> files{0};
+    std::atomic<std::uint64_t> failed{0};
+    std::atomic<std::uint64_t> skipped{0};
+    std::atomic<std::uint64_t> bytesIn{0};
+    std::atomic<std::uint64_t> bytesOut{0};
+
+private:
+    const QString sourceDir;
+    const QString targetDir;
+    const OutputFormat target;
+    const int batchSize;
+
+    std::mutex iteratorMutex;
+    QStringList directories;                // still to be listed
+    std::unique_ptr<QDirIterator> iterator; // files of the current directory
+    std::vector<std::uint64_t> done;        // sorted pathHash() of the journalled files
+    QHash<QString, QString> claimed;        // output path -> source, current directory
+
+    std::mutex journalMutex;
+    QFile journal;
+
+    bool nextBatch(std::vector<Job> &batch)
+    {
+        batch.clear();
+        std::lock_guard lock(iteratorMutex);
+        while (static_cast<int>(batch.size()) < batchSize && hasNextFile())
+        {
+            const QFileInfo info(iterator->next());
+            const auto fmt = outputFormatFromExtension(("." + info.suffix().toLower()).toStdString());
+            if (!fmt)
+            {
+                continue;
+            }
+            QString relative = QDir(sourceDir).relativeFilePath(info.absoluteFilePath());
+            // sources differing in the extension only ("a.json", "a.cbor") map to one
+            // output, the first one found is converted
+            const QString output = targetPath(relative);
+            if (const auto claim = claimed.constFind(output); claim != claimed.cend())
+            {
+                ++failed;
+                std::cerr << std::format("failed: {}: same output as {}\n",
+                                         info.absoluteFilePath().toStdString(),
+                                         claim.value().toStdString());
+                continue;
+            }
+            claimed.insert(output, relative);
+            if (std::binary_search(done.begin(), done.end(), pathHash(relative)))
+            {
+                ++skipped;
+                continue;
+            }
+            batch.push_back({info.absoluteFilePath(), std::move(relative), *fmt});
+        }
+        return !batch.empty();
+    }
+
+    // the files of one directory are listed together: outputs can only collide within
+    // one directory, its claims are dropped with it
+    bool hasNextFile()
+    {
+        while (!iterator || !iterator->hasNext())
+        {
+            if (directories.isEmpty())
+            {
+                return false;
+            }
+            const QString directory = directories.takeLast();
+            QDirIterator subdirectories(directory, QDir::Dirs | QDir::NoDotAndDotDot | QDir::NoSymLinks);
+            while (subdirectories.hasNext())
+            {
+                const QString subdirectory = subdirectories.next();
+                // a target inside the source tree holds outputs of this run
+                if (subdirectory != targetDir)
+                {
+                    directories.append(subdirectory);
+                }
+            }
+            claimed.clear();
+            iterator = std::make_unique<QDirIterator>(directory, QDir::Files);
+        }
+        return true;
+    }
+
+    void work()
+    {
+        std::vector<Job> batch;
+        std::vector<Output> outputs;
+        QStringList finished;
+        nlohmann::json record;
+        Rz_recordNodes nodes;
+
+        while (nextBatch(batch))
+        {
+            std::size_t pending = 0;
+            for (const auto &job : batch)
+            {
+                Output output{targetPath(job.relative), {}};
+                if (!transcode(job, record, nodes, output.data))
+                {
+                    ++failed;
+                    std::cerr << std::format("failed: {}\n", job.source.toStdString());
+                    continue;
+                }
+                pending += output.data.size();
+                outputs.push_back(std::move(output));
+                finished.append(job.relative);
+
+                if (pending >= maxBatchBytes)
+                {
+                    writeBatch(outputs, finished);
+                    pending = 0;
+                }
+            }
+            writeBatch(outputs, finished);
+        }
+    }
+
+    QString targetPath(const QString &relative) const
+    {
+        const QFileInfo info(relative);
+        const QString ext = QString::fromUtf8(outputFormatExtension(target).data(),
+                                              outputFormatExtension(target).size());
+        return QDir::cleanPath(targetDir + "/" + info.path() + "/" + info.completeBaseName() + ext);
+    }
+
+    bool transcode(const Job &job, nlohmann::json &record, Rz_recordNodes &nodes, std::string &out)
+    {
+        QFile in(job.source);
+        if (!in.open(QIODevice::ReadOnly) || in.size() == 0)
+        {
+            return false;
+        }
+        const qint64 size = in.size();
+        uchar *data = in.map(0, size);
+        if (data == nullptr)
+        {
+            return false;
+        }
+        const bool decoded = decodeRecord(job.sourceFormat, data, static_cast<std::size_t>(size), record);
+        in.unmap(data);
+        if (!decoded || !nodes.assign(record))
+        {
+            return false;
+        }
+
+        Rz_bufferSink sink;
+        sink.data.reserve(static_cast<std::size_t>(size));
+        Rz_streamEncoder encoder(target, sink);
+        bool ok = encoder.encode(nodes.root());
+        if (ok && target == OutputFormat::JSON)
+        {
+            ok = encoder.write("\n", 1);
+        }
+        if (!encoder.flush() || !ok)
+        {
+            return false;
+        }
+
+        bytesIn += static_cast<std::uint64_t>(size);
+        out = std::move(sink.data);
+        return true;
+    }
+
+    void writeBatch(std::vector<Output> &outputs, QStringList &finished)
+    {
+        QStringList written;
+        for (qsizetype i = 0; i < static_cast<qsizetype>(outputs.size()); ++i)
+        {
+            const auto &output = outputs[i];
+            QDir().mkpath(QFileInfo(output.path).absolutePath());
+
+            // written to a temporary file and renamed, a killed run leaves no partial outputs
+            const std::string path = output.path.toStdString();
+            const std::string tmpPath = sharedTmpPath(path);
+            std::string error;
+            QFile file(QString::fromStdString(tmpPath));
+            bool ok = file.open(QIODevice::WriteOnly | QIODevice::NewOnly)
+                      && file.write(output.data.data(), static_cast<qint64>(output.data.size()))
+                             == static_cast<qint64>(output.data.size());
+            file.close();
+            ok = ok && file.error() == QFileDevice::NoError;
+            if (!ok)
+            {
+                file.remove();
+            }
+            if (!ok || !publishFile(tmpPath, path, error))
+            {
+                ++failed;
+                std::cerr << std::format("failed: {}\n", path);
+                continue;
+            }
+            ++files;
+            bytesOut += output.data.size();
+            written.append(finished.at(i));
+        }
+        outputs.clear();
+        finished.clear();
+        if (written.isEmpty())
+        {
+            return;
+        }
+
+        // one sync per batch: the journal never claims outputs still in the page cache
+#if defined(__linux__)
+        const bool synced = ::syncfs(journal.handle()) == 0;
+#else
+        ::sync();
+        const bool synced = true;
+#endif
+        if (!synced)
+        {
+            std::cerr << std::format("failed: sync of {}, the batch is written again on resume\n",
+                                     targetDir.toStdString());
+            return;
+        }
+        const QByteArray lines = (written.join('\n') + '\n').toUtf8();
+        std::lock_guard lock(journalMutex);
+        if (journal.write(lines) != lines.size() || !journal.flush())
+        {
+            ++failed;
+            std::cerr << std::format("failed: journal of {}: {}, the batch is written again on resume\n",
+                                     targetDir.toStdString(),
+                                     journal.errorString().toStdString());
+        }
+    }
+};
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("rz_transcode");
+    QCoreApplication::setApplicationVersion(QString::fromStdString(PROJECT_VERSION));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("convert exported metadata between JSON, BSON, CBOR, "
+                                     "MessagePack, UBJSON and BJData");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("source", "directory tree with exported records");
+    parser.addPositionalArgument("target", "output directory");
+    parser.addPositionalArgument("format", "JSON, BSON, CBOR, MSGPACK, UBJSON or BJDATA");
+    const QCommandLineOption jobsOption({"j", "jobs"},
+                                        "number of worker threads",
+                                        "N",
+                                        QString::number(std::thread::hardware_concurrency()));
+    const QCommandLineOption batchOption({"b", "batch"}, "files per batch", "N", "64");
+    const QCommandLineOption resumeOption({"r", "resume"}, "skip files finished by a previous run");
+    parser.addOption(jobsOption);
+    parser.addOption(batchOption);
+    parser.addOption(resumeOption);
+    parser.process(app);
+
+    const QStringList args = parser.positionalArguments();
+    if (args.size() != 3)
+    {
+        parser.showHelp(EXIT_FAILURE);
+    }
+
+    const auto target = outputFormatFromName(args.at(2).toUpper().toStdString());
+    if (!target)
+    {
+        std::cerr << std::format("unknown format: {}\n", args.at(2).toStdString());
+        return EXIT_FAILURE;
+    }
+    const int jobs = std::max(1, parser.value(jobsOption).toInt());
+    const int batch = std::max(1, parser.value(batchOption).toInt());
+
+    if (QDir(args.at(0)).absolutePath() == QDir(args.at(1)).absolutePath())
+    {
+        std::cerr << "the target directory must not be the source directory\n";
+        return EXIT_FAILURE;
+    }
+
+    Rz_transcoder transcoder(args.at(0), args.at(1), *target, batch);
+    if (!transcoder.openJournal(parser.isSet(resumeOption)))
+    {
+        std::cerr << std::format("unable to open the journal in {}\n", args.at(1).toStdString());
+        return EXIT_FAILURE;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    transcoder.run(jobs);
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    const double seconds = std::max(elapsed.count(), 1e-9);
+    std::cout << std::format("files: {} failed: {} skipped: {}\n",
+                             transcoder.files.load(),
+                             transcoder.failed.load(),
+                             transcoder.skipped.load());
+    std::cout << std::format("in: {:.1f} MB out: {:.1f} MB time: {:.2f} s ({:.0f} files/s, {:.1f} MB/s)\n",
+                             transcoder.bytesIn.load() / 1e6,
+                             transcoder.bytesOut.load() / 1e6,
+                             seconds,
+                             transcoder.files.load() / seconds,
+                             transcoder.bytesIn.load() / 1e6 / seconds);
+
+    return transcoder.failed.load() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
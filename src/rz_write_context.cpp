@@ -0,0 +1,2370 @@
+/**
+ * @file rz_write_context.cpp
+ * @author ZHENG Robert (robert.hase-zheng.net)
+ * @brief independent writer context of the rz_write_json plugin
+ * @version 0.1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2025 ZHENG Robert
+ *
+ */
+
+#include "includes/rz_write_context.hpp"
+
+#include <QDir>
+#include <QSaveFile>
+#include <unistd.h>
+#include "includes/rz_blob_store.hpp"
+#include "includes/rz_change_log.hpp"
+#include "includes/rz_checkpoint.hpp"
+#include "includes/rz_config.hpp"
+#include "includes/rz_record_cache.hpp"
+#include "includes/rz_record_codec.hpp"
+#include "includes/rz_record_scanner.hpp"
+#include "includes/rz_shared_output.hpp"
+#include <chrono>
+#include <format>
+
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include <utility>
+
+namespace
+{
+/**
+ * @brief The QFileSink class
+ * @details passes the encoded chunks directly to the file
+ */
+class QFileSink : public Rz_byteSink
+{
+public:
+    explicit QFileSink(QFile &file)
+        : file(file)
+    {}
+
+    bool write(const char *data, std::size_t size) override
+    {
+        return file.write(data, static_cast<qint64>(size)) == static_cast<qint64>(size);
+    }
+
+private:
+    QFile &file;
+};
+
+Rz_text toText(const QString &string)
+{
+    return std::u16string_view(reinterpret_cast<const char16_t *>(string.utf16()),
+                               static_cast<std::size_t>(string.size()));
+}
+
+/**
+ * @brief cachePath
+ * @return key of the file in the record cache
+ */
+std::string cachePath(const QString &path)
+{
+    return QDir::cleanPath(QFileInfo(path).absoluteFilePath()).toStdString();
+}
+
+bool nodeLess(const Rz_streamEncoder::Node &lhs, const Rz_streamEncoder::Node &rhs)
+{
+    return Rz_streamEncoder::less(lhs.key, rhs.key);
+}
+
+using SectionNodes = std::array<std::vector<Rz_streamEncoder::Node>, Rz_metaRecord::sectionCount>;
+
+/**
+ * @brief recordNodes
+ * @details encoder nodes of the record: PICTURE fields and the EXIF, IPTC and XMP
+ * objects (always written, even if empty), views into the record buffer
+ */
+void recordNodes(const Rz_metaRecord &record,
+                 SectionNodes &sections,
+                 std::vector<Rz_streamEncoder::Node> &root)
+{
+    const auto &keys = Rz_writeShared::sectionKeys;
+
+    for (std::size_t s = 1; s < Rz_metaRecord::sectionCount; ++s)
+    {
+        const auto entries = record.section(static_cast<Rz_section>(s));
+        sections[s].clear();
+        sections[s].reserve(entries.size());
+        for (const auto &entry : entries)
+        {
+            sections[s].push_back({record.key(entry), record.value(entry)});
+        }
+    }
+
+    root.clear();
+    for (const auto &entry : record.section(Rz_section::PICTURE))
+    {
+        // the sections win over picture keys of the same name
+        const std::string_view key = record.key(entry);
+        if (std::find(keys.begin() + 1, keys.end(), key) == keys.end())
+        {
+            root.push_back({key, record.value(entry)});
+        }
+    }
+    for (std::size_t s = 1; s < Rz_metaRecord::sectionCount; ++s)
+    {
+        root.push_back({keys[s], std::string_view{}, &sections[s]});
+    }
+    std::sort(root.begin(), root.end(), nodeLess);
+}
+
+/**
+ * @brief encodeSection
+ * @details the section as a standalone object, which is also its encoding as a value
+ * of the top-level object (BSON: embedded document)
+ */
+bool encodeSection(OutputFormat format, const Rz_metaRecord &record, Rz_section section, std::string &out)
+{
+    std::vector<Rz_streamEncoder::Node> nodes;
+    for (const auto &entry : record.section(section))
+    {
+        nodes.push_back({record.key(entry), record.value(entry)});
+    }
+
+    Rz_bufferSink sink;
+    Rz_streamEncoder encoder(format, sink);
+    const bool ok = encoder.encode(nodes) && encoder.flush();
+    out = std::move(sink.data);
+    return ok;
+}
+
+/**
+ * @brief mergeSection
+ * @details existing keys of the encoded section, overwritten by the keys of the record
+ * @return false if the section can't be decoded or contains nested values
+ */
+bool mergeSection(OutputFormat format,
+                  std::string_view encoded,
+                  const Rz_metaRecord &record,
+                  Rz_section section,
+                  Rz_metaRecord &merged)
+{
+    nlohmann::json existing;
+    if (!decodeRecord(format,
+                      reinterpret_cast<const std::uint8_t *>(encoded.data()),
+                      encoded.size(),
+                      existing))
+    {
+        return false;
+    }
+
+    merged.beginSection(section);
+    for (auto it = existing.cbegin(); it != existing.cend(); ++it)
+    {
+        if (it.value().is_structured())
+        {
+            return false;
+        }
+        const std::string value = it.value().is_string() ? it.value().get<std::string>()
+                                                          : it.value().dump();
+        if (!merged.add(std::string_view(it.key()), std::string_view(value)))
+        {
+            return false;
+        }
+    }
+    for (const auto &entry : record.section(section))
+    {
+        if (!merged.add(record.key(entry), record.value(entry)))
+        {
+            return false;
+        }
+    }
+    merged.endSection();
+    return true;
+}
+
+/**
+ * @brief rewriteRecord
+ * @details fallback of the update mode: decode the existing output, replace or merge
+ * the sections of the record and encode it again
+ */
+bool rewriteRecord(OutputFormat format,
+                   std::string_view data,
+                   const Rz_metaRecord &record,
+                   const std::array<bool, Rz_metaRecord::sectionCount> &mergeKeys,
+                   std::string &out)
+{
+    nlohmann::json doc;
+    if (!decodeRecord(format, reinterpret_cast<const std::uint8_t *>(data.data()), data.size(), doc))
+    {
+        return false;
+    }
+
+    for (std::size_t s = 1; s < Rz_metaRecord::sectionCount; ++s)
+    {
+        if (!record.hasSection(static_cast<Rz_section>(s)))
+        {
+            continue;
+        }
+        auto &target = doc[std::string(Rz_writeShared::sectionKeys[s])];
+        if (!mergeKeys[s] || !target.is_object())
+        {
+            target = nlohmann::json::object();
+        }
+        for (const auto &entry : record.section(static_cast<Rz_section>(s)))
+        {
+            target[std::string(record.key(entry))] = std::string(record.value(entry));
+        }
+    }
+
+    Rz_recordNodes nodes;
+    if (!nodes.assign(doc))
+    {
+        return false;
+    }
+    Rz_bufferSink sink;
+    Rz_streamEncoder encoder(format, sink);
+    bool ok = encoder.encode(nodes.root());
+    if (ok && format == OutputFormat::JSON)
+    {
+        ok = encoder.write("\n", 1);
+    }
+    ok = encoder.flush() && ok;
+    out = std::move(sink.data);
+    return ok;
+}
+} // namespace
+
+std::shared_ptr<const Rz_writeShared> Rz_writeShared::instance()
+{
+    static const auto shared = std::make_shared<const Rz_writeShared>();
+    return shared;
+}
+
+Rz_writeContext::Rz_writeContext(std::shared_ptr<const Rz_writeShared> shared)
+    : shared(std::move(shared))
+{
+    setIndexFields({"XMP.keywords", "XMP.city", "XMP.countryname", "XMP.title", "IPTC.caption"});
+}
+
+std::shared_ptr<Plugin> Rz_writeContext::createContext()
+{
+    return std::make_shared<Rz_writeContext>(shared);
+}
+
+QString Rz_writeContext::extensionFromEnum(OutputFormat fmt)
+{
+    const std::string_view extension = outputFormatExtension(fmt);
+    return QString::fromLatin1(extension.data(), static_cast<qsizetype>(extension.size()));
+}
+
+std::optional<OutputFormat> Rz_writeContext::enumFromString(const QString &type)
+{
+    return outputFormatFromName(type.toUpper().toStdString());
+}
+
+std::tuple<bool, std::string> Rz_writeContext::isTargetExist(const QFile &pathToTarget,
+                                                          const QString &type)
+{
+    const QFileInfo fInfo(pathToTarget);
+
+    msg = "";
+    oknok = false;
+
+    if (type.contains("dir"))
+    {
+        if (!pathToTarget.exists())
+        {
+            qDebug() << "createDirectories(fInfo.absolutePath().toStdString(): "
+                     << fInfo.absolutePath().toStdString();
+            std::tie(oknok, msg) = createDirectories(fInfo.absoluteFilePath().toStdString());
+        }
+        if (fInfo.isDir() && fInfo.isWritable())
+        {
+            return std::make_tuple(true,
+                                   std::format("{}:{}:{}: Folder exists and is writeable.",
+                                               __FILE__,
+                                               __FUNCTION__,
+                                               __LINE__));
+        }
+        else
+        {
+            return std::make_tuple(
+                true,
+                std::format("{}:{}:{}: Target is not a directory or not writeable.",
+                            __FILE__,
+                            __FUNCTION__,
+                            __LINE__));
+        }
+    }
+    if (!pathToTarget.exists())
+    {
+        return std::make_tuple(false,
+                               std::format("{}:{}:{}: Target doesn't exist.",
+                                           __FILE__,
+                                           __FUNCTION__,
+                                           __LINE__));
+    }
+    if (type.contains("file") && fInfo.isFile() && fInfo.isWritable())
+    {
+        return std::make_tuple(true,
+                               std::format("{}:{}:{}: File exists and is writeable",
+                                           __FILE__,
+                                           __FUNCTION__,
+                                           __LINE__));
+    }
+    return std::make_tuple(false, std::format("{}:{}", __FILE__, __FUNCTION__));
+}
+
+std::tuple<bool, std::string> Rz_writeContext::createDirectories(const std::filesystem::path &p)
+{
+    std::filesystem::path nested = p;
+
+    try
+    {
+        // a directory created by another process meanwhile is fine as well
+        if (std::filesystem::create_directories(nested) || std::filesystem::is_directory(nested))
+        {
+            return std::make_tuple(true,
+                                   std::format("{}:{}:{}: Nested directories created successfully",
+                                               __FILE__,
+                                               __FUNCTION__,
+                                               __LINE__));
+        }
+        else
+        {
+            return std::make_tuple(false,
+                                   std::format("{}:{}:{}: Failed to create nested directories",
+                                               __FILE__,
+                                               __FUNCTION__,
+                                               __LINE__));
+            // std::cout << ec.message() << '\n';
+        }
+    }
+    catch (const std::exception &ex)
+    {
+        std::string msg = std::format("{}:{}:{}: Failed creating directories: ",
+                                      __FILE__,
+                                      __FUNCTION__,
+                                      __LINE__);
+        msg.append(ex.what());
+        return std::make_tuple(false, msg);
+    }
+}
+
+QString Rz_writeContext::getPluginNameShort()
+{
+    return PROJECT_NAME.c_str();
+}
+
+QString Rz_writeContext::getPluginNameLong()
+{
+    return PROG_LONGNAME.c_str();
+}
+
+QString Rz_writeContext::getPluginVersion()
+{
+    std::string ret = std::format("{}-v{}", PROJECT_NAME, PROJECT_VERSION);
+    return ret.c_str();
+}
+
+QString Rz_writeContext::getPluginDescription()
+{
+    return PROJECT_DESCRIPTION.c_str();
+}
+
+int32_t Rz_writeContext::getPluginMajorVersion()
+{
+    return PROJECT_VERSION_MAJOR;
+}
+
+int32_t Rz_writeContext::getPluginMinorVersion()
+{
+    return PROJECT_VERSION_MINOR;
+}
+
+int32_t Rz_writeContext::getPluginPatchVersion()
+{
+    return PROJECT_VERSION_PATCH;
+}
+
+QString Rz_writeContext::getPluginHomepageUrl()
+{
+    return PROJECT_HOMEPAGE_URL.c_str();
+}
+
+QString Rz_writeContext::getPluginCopyright()
+{
+    const auto now = std::chrono::system_clock::now();
+    std::string ret = std::format("Copyright {}-{:%Y} {}", PROG_CREATED, now, PROG_AUTHOR);
+    return ret.c_str();
+}
+
+QString Rz_writeContext::getPluginTechInfo()
+{
+    std::string ret = std::format("{} {} QT {}",
+                                  CMAKE_CXX_COMPILER,
+                                  CMAKE_CXX_STANDARD,
+                                  CMAKE_QT_VERSION);
+    return ret.c_str();
+}
+
+/**
+ * @brief Rz_writeContext::parseFile
+ * @param type <path to an exported record, format from the extension>
+ * @details the top-level members are located without decoding; without lazy mode all
+ * sections are decoded into the current record, as if set by setQHash(). With the
+ * record cache (setQstring("cache")) a record decoded before from the same version of
+ * the file is copied instead; lazy mode reads cached records too, but doesn't add any
+ * @return <bool, msg string>
+ */
+std::tuple<bool, std::string> Rz_writeContext::parseFile(const QString &pathToFile)
+{
+    closeParsed();
+
+    const QFileInfo fileInfo(pathToFile);
+    const auto format = outputFormatFromExtension(("." + fileInfo.suffix().toLower()).toStdString());
+    if (!format)
+    {
+        return std::make_tuple(false,
+                               std::format("{}:{}:{}: unknown format {}",
+                                           __FILE__,
+                                           __FUNCTION__,
+                                           __LINE__,
+                                           pathToFile.toStdString()));
+    }
+
+    auto &cache = Rz_recordCache::instance();
+    const std::string cacheKey = cache.capacity() > 0 ? cachePath(pathToFile) : std::string();
+    Rz_recordCache::Stamp stamp;
+    const bool cacheable = !cacheKey.empty() && Rz_recordCache::stamp(cacheKey, stamp);
+    if (cacheable)
+    {
+        if (const auto cached = cache.find(cacheKey, stamp))
+        {
+            record = *cached;
+            mergeKeys.fill(false);
+            recordWritten = false;
+            return std::make_tuple(true,
+                                   std::format("{}:{}: {} cached", __FILE__, __FUNCTION__, pathToFile.toStdString()));
+        }
+    }
+
+    parsedFile.setFileName(pathToFile);
+    if (!parsedFile.open(QIODevice::ReadOnly) || parsedFile.size() == 0
+        || (parsedData = parsedFile.map(0, parsedFile.size())) == nullptr)
+    {
+        const std::string error = parsedFile.errorString().toStdString();
+        closeParsed();
+        return std::make_tuple(false,
+                               std::format("{}:{}:{}: Unable to read file {}: {}",
+                                           __FILE__,
+                                           __FUNCTION__,
+                                           __LINE__,
+                                           pathToFile.toStdString(),
+                                           error));
+    }
+    parsedFormat = *format;
+    if (!scanRecord(parsedFormat, parsedBytes(), parsedEntries))
+    {
+        closeParsed();
+        return std::make_tuple(false,
+                               std::format("{}:{}:{}: {} is not a record",
+                                           __FILE__,
+                                           __FUNCTION__,
+                                           __LINE__,
+                                           pathToFile.toStdString()));
+    }
+
+    // manifest of the dedup output: the sections are references into the blob store
+    std::string value;
+    for (const auto &entry : parsedEntries)
+    {
+        const auto section = std::find(Rz_writeShared::sectionKeys.begin() + 1,
+                                       Rz_writeShared::sectionKeys.end(),
+                                       entry.key);
+        if (entry.object || section == Rz_writeShared::sectionKeys.end()
+            || !decodeScalar(parsedFormat, parsedBytes(), entry, value)
+            || !value.starts_with(Rz_blobStore::referencePrefix))
+        {
+            continue;
+        }
+        const auto s = static_cast<std::size_t>(section - Rz_writeShared::sectionKeys.begin());
+        const auto store = Rz_blobStore::open(fileInfo.absolutePath().toStdString());
+        if (!store->get(fileInfo.completeBaseName().toStdString(),
+                        entry.key,
+                        ("." + fileInfo.suffix().toLower()).toStdString(),
+                        std::string_view(value).substr(Rz_blobStore::referencePrefix.size()),
+                        parsedBlobs[s]))
+        {
+            closeParsed();
+            return std::make_tuple(false,
+                                   std::format("{}:{}:{}: section {} of {} not in the blob store",
+                                               __FILE__,
+                                               __FUNCTION__,
+                                               __LINE__,
+                                               entry.key,
+                                               pathToFile.toStdString()));
+        }
+    }
+
+    if (lazyMode)
+    {
+        return std::make_tuple(true,
+                               std::format("{}:{}: {} lazy, {} members",
+                                           __FILE__,
+                                           __FUNCTION__,
+                                           pathToFile.toStdString(),
+                                           parsedEntries.size()));
+    }
+
+    record.clear();
+    mergeKeys.fill(false);
+    recordWritten = false;
+    bool added = true;
+    for (std::size_t s = 0; s < Rz_metaRecord::sectionCount; ++s)
+    {
+        const auto section = static_cast<Rz_section>(s);
+        record.beginSection(section);
+        decodeParsed(section, [this, &added](std::string_view key, std::string_view value) {
+            added = record.add(key, value) && added;
+        });
+        record.endSection();
+    }
+    closeParsed();
+    if (!added)
+    {
+        record.clear();
+        return std::make_tuple(false,
+                               std::format("{}:{}:{}: {} exceeds {} bytes of keys and values",
+                                           __FILE__,
+                                           __FUNCTION__,
+                                           __LINE__,
+                                           pathToFile.toStdString(),
+                                           Rz_metaRecord::maxBytes));
+    }
+    if (cacheable)
+    {
+        cache.insert(cacheKey, stamp, std::make_shared<const Rz_metaRecord>(record));
+    }
+
+    return std::make_tuple(true, std::format("{}:{}: {}", __FILE__, __FUNCTION__, pathToFile.toStdString()));
+}
+
+void Rz_writeContext::closeParsed()
+{
+    if (parsedData != nullptr)
+    {
+        parsedFile.unmap(parsedData);
+        parsedData = nullptr;
+    }
+    parsedFile.close();
+    parsedEntries.clear();
+    for (auto &blob : parsedBlobs)
+    {
+        blob.clear();
+    }
+}
+
+std::string_view Rz_writeContext::parsedBytes() const
+{
+    if (parsedData == nullptr)
+    {
+        return {};
+    }
+    return std::string_view(reinterpret_cast<const char *>(parsedData),
+                            static_cast<std::size_t>(parsedFile.size()));
+}
+
+/**
+ * @brief Rz_writeContext::parsedSection
+ * @return encoded object of the EXIF, IPTC or XMP section in the parsed file
+ */
+std::optional<std::string_view> Rz_writeContext::parsedSection(Rz_section section) const
+{
+    if (!parsedBlobs[static_cast<std::size_t>(section)].empty())
+    {
+        return parsedBlobs[static_cast<std::size_t>(section)];
+    }
+    const auto &key = Rz_writeShared::sectionKeys[static_cast<std::size_t>(section)];
+    for (const auto &entry : parsedEntries)
+    {
+        if (entry.object && entry.key == key)
+        {
+            return parsedBytes().substr(entry.offset, entry.size);
+        }
+    }
+    return std::nullopt;
+}
+
+/**
+ * @brief Rz_writeContext::decodeParsed
+ * @details decodes one section of the parsed file, the other sections are skipped by
+ * their offsets; PICTURE are the scalar top-level members
+ */
+void Rz_writeContext::decodeParsed(Rz_section section, const Visitor &visit) const
+{
+    std::string value;
+    if (section == Rz_section::PICTURE)
+    {
+        for (const auto &entry : parsedEntries)
+        {
+            // section references of a dedup manifest aren't PICTURE fields
+            const bool reference = std::find(Rz_writeShared::sectionKeys.begin() + 1,
+                                             Rz_writeShared::sectionKeys.end(),
+                                             entry.key)
+                                   != Rz_writeShared::sectionKeys.end();
+            if (!reference && decodeScalar(parsedFormat, parsedBytes(), entry, value))
+            {
+                visit(entry.key, value);
+            }
+        }
+        return;
+    }
+
+    const auto bytes = parsedSection(section);
+    std::vector<Rz_scanEntry> entries;
+    if (!bytes || !scanRecord(parsedFormat, *bytes, entries))
+    {
+        return;
+    }
+    for (const auto &entry : entries)
+    {
+        if (decodeScalar(parsedFormat, *bytes, entry, value))
+        {
+            visit(entry.key, value);
+        }
+    }
+}
+
+/**
+ * @brief Rz_writeContext::parsedValue
+ * @param keyPath <SECTION>.<key>, e.g. "EXIF.gpslatitude" or "PICTURE.filewidth"
+ * @return the value from the parsed file (lazy mode) or the current record
+ */
+QString Rz_writeContext::parsedValue(const QString &keyPath) const
+{
+    const qsizetype dot = keyPath.indexOf('.');
+    const auto section = dot > 0 ? sectionFromType(keyPath.left(dot)) : std::nullopt;
+    if (!section)
+    {
+        return "";
+    }
+    const std::string key = keyPath.mid(dot + 1).toStdString();
+
+    if (parsedData == nullptr)
+    {
+        const auto value = record.find(*section, key);
+        return value ? QString::fromUtf8(value->data(), static_cast<qsizetype>(value->size())) : QString();
+    }
+
+    const std::string_view bytes = *section == Rz_section::PICTURE ? parsedBytes()
+                                                                    : parsedSection(*section).value_or("");
+    std::vector<Rz_scanEntry> scanned;
+    const std::vector<Rz_scanEntry> *entries = &parsedEntries;
+    if (*section != Rz_section::PICTURE)
+    {
+        if (bytes.empty() || !scanRecord(parsedFormat, bytes, scanned))
+        {
+            return "";
+        }
+        entries = &scanned;
+    }
+    std::string value;
+    for (const auto &entry : *entries)
+    {
+        if (entry.key == key && decodeScalar(parsedFormat, bytes, entry, value))
+        {
+            return QString::fromUtf8(value.data(), static_cast<qsizetype>(value.size()));
+        }
+    }
+    return "";
+}
+
+/**
+ * @brief Rz_writeContext::writeFile
+ * @param type <path to output folder>, ignored with striped output
+ * @details striped output is queued, see doRun("flush"); with a checkpoint journal
+ * records completed by an earlier run are skipped, see setQstring("checkpoint")
+ * @return <bool, msg string>
+ */
+std::tuple<bool, std::string> Rz_writeContext::writeFile(const QString &pathToBinDir)
+{
+    // striping: the root of the record replaces the output folder
+    const bool striped = !stripeRoots.isEmpty();
+    const std::size_t stripe = striped ? Rz_stripeWriter::stripeOf(imgStruct.fileBasename.toStdString(),
+                                                                     static_cast<std::size_t>(stripeRoots.size()))
+                                       : 0;
+    const QString targetDir = striped ? stripeRoots[static_cast<qsizetype>(stripe)] : pathToBinDir;
+
+    // journalled by output file name: other formats of the image are other files;
+    // updates are always written
+    const std::string name = (imgStruct.fileBasename + outputExtension).toStdString();
+    const auto journal = checkpointEnabled ? checkpointOf(targetDir) : nullptr;
+    if (journal && !updateMode && journal->contains(name))
+    {
+        journal->skipped();
+        recordWritten = true;
+        return std::make_tuple(true,
+                               std::format("{}:{}: {} already exported", __FILE__, __FUNCTION__, name));
+    }
+    auto result = writeRecord(targetDir, striped, stripe);
+
+    // the cached record of the previous version is stale, whether the write succeeded or not
+    if (auto &cache = Rz_recordCache::instance(); cache.capacity() > 0)
+    {
+        cache.invalidate(cachePath(targetDir + "/" + imgStruct.fileBasename + outputExtension));
+    }
+    if (journal && std::get<0>(result))
+    {
+        // queued files count once they are written, see drainStripes()
+        if (striped)
+        {
+            checkpointQueued.resize(stripeWriters.size());
+            checkpointQueued[stripe].push_back(name);
+        }
+        else
+        {
+            journal->complete(name);
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Rz_writeContext::checkpointOf
+ * @return the checkpoint journal of the output folder
+ */
+std::shared_ptr<Rz_checkpoint> Rz_writeContext::checkpointOf(const QString &pathToBinDir)
+{
+    const QString dir = QDir(pathToBinDir).absolutePath();
+    auto &journal = checkpoints[dir];
+    if (!journal)
+    {
+        journal = Rz_checkpoint::open(dir.toStdString());
+    }
+    return journal;
+}
+
+/**
+ * @brief Rz_writeContext::flushCheckpoints
+ * @details appends the completed records to the journals
+ */
+bool Rz_writeContext::flushCheckpoints()
+{
+    bool ok = true;
+    for (const auto &journal : std::as_const(checkpoints))
+    {
+        ok = journal->flush() && ok;
+    }
+    return ok;
+}
+
+/**
+ * @brief Rz_writeContext::writeRecord
+ * @details writes the current record into the output folder or its archive
+ * @return <bool, msg string>
+ */
+std::tuple<bool, std::string> Rz_writeContext::writeRecord(const QString &targetDir, bool striped, std::size_t stripe)
+{
+    std::tie(oknok, msg) = isTargetExist(QFile(targetDir), "dir");
+    if (!oknok)
+    {
+        return std::make_tuple(false,
+                               std::format("{}:{}:{}: {}", __FILE__, __FUNCTION__, __LINE__, msg));
+    }
+
+    QString binFile = targetDir + "/" + imgStruct.fileBasename + outputExtension; // + ".json";
+    const auto format = static_cast<OutputFormat>(outputFormatFlag);
+
+    if (archiveEnabled)
+    {
+        return appendToArchive(targetDir, format);
+    }
+
+    // PICTURE fields are spread over the top-level object, they need a full write;
+    // a queued write of the file must be finished before it is updated
+    const bool update = updateMode && !record.hasSection(Rz_section::PICTURE);
+    if (update && striped)
+    {
+        stripeErrors += drainStripe(stripe);
+    }
+
+    // change feed: the previous export of the record, read before it is replaced; a
+    // queued write isn't on disk yet, its delta holds the previous record then
+    const bool feed = changeFeed;
+    const std::string name = imgStruct.fileBasename.toStdString();
+    nlohmann::json before;
+    if (feed)
+    {
+        const QueuedChange *queued = nullptr;
+        if (striped)
+        {
+            changesQueued.resize(stripeWriters.size());
+            const std::string fileName = name + outputExtension.toStdString();
+            for (const auto &change : changesQueued[stripe])
+            {
+                queued = change.fileName == fileName ? &change : queued;
+            }
+        }
+        before = queued ? queued->after : exportedRecord(binFile, format);
+    }
+
+    if (dedupEnabled)
+    {
+        auto result = writeDeduplicated(targetDir, binFile, format);
+        if (feed && std::get<0>(result)
+            && !logChange(targetDir, name, std::move(before), exportedRecord(binFile, format)))
+        {
+            return std::make_tuple(false,
+                                   std::format("{}:{}:{}: Unable to append to the change feed of {}",
+                                               __FILE__,
+                                               __FUNCTION__,
+                                               __LINE__,
+                                               binFile.toStdString()));
+        }
+        return result;
+    }
+
+    if (update && QFileInfo::exists(binFile))
+    {
+        auto result = updateFile(binFile, format);
+        if (std::get<0>(result))
+        {
+            if (auto indexed = indexRecord(targetDir, binFile); !std::get<0>(indexed))
+            {
+                return indexed;
+            }
+            if (feed && !logChange(targetDir, name, std::move(before), exportedRecord(binFile, format)))
+            {
+                return std::make_tuple(false,
+                                       std::format("{}:{}:{}: Unable to append to the change feed of {}",
+                                                   __FILE__,
+                                                   __FUNCTION__,
+                                                   __LINE__,
+                                                   binFile.toStdString()));
+            }
+        }
+        return result;
+    }
+
+    if (striped)
+    {
+        // the delta is logged once the file is written, see drainStripes()
+        auto result = enqueueStriped(stripe, format);
+        if (feed && std::get<0>(result))
+        {
+            changesQueued[stripe].push_back(
+                {name + outputExtension.toStdString(), name, std::move(before), recordJson()});
+        }
+        return result;
+    }
+
+    // shared output: written under a name of its own, renamed into place when complete
+    const std::string tmpFile = sharedMode ? sharedTmpPath(binFile.toStdString()) : std::string();
+    QFile fileOut(sharedMode ? QString::fromStdString(tmpFile) : binFile);
+    QIODevice::OpenMode mode = QIODevice::WriteOnly | QIODevice::Unbuffered;
+    if (sharedMode)
+    {
+        mode |= QIODevice::NewOnly;
+    }
+    if (format == OutputFormat::JSON)
+    {
+        mode |= QIODevice::Text;
+    }
+    if (!fileOut.open(mode))
+    {
+        return std::make_tuple(false,
+                               std::format("{}:{}: Unable to write file {}.",
+                                           __FILE__,
+                                           __FUNCTION__,
+                                           fileOut.errorString().toStdString()));
+    }
+
+    // the encoder reads the record buffer in place and writes it in chunks,
+    // no copies, no DOM and no complete output buffer
+    SectionNodes sections;
+    std::vector<Rz_streamEncoder::Node> root;
+    recordNodes(record, sections, root);
+
+    QFileSink sink(fileOut);
+    Rz_streamEncoder encoder(format, sink);
+    oknok = encoder.encode(root);
+    if (oknok && format == OutputFormat::JSON)
+    {
+        oknok = encoder.write("\n", 1);
+    }
+    oknok = encoder.flush() && oknok;
+
+    if (!oknok)
+    {
+        fileOut.close();
+        if (sharedMode)
+        {
+            fileOut.remove();
+        }
+        return std::make_tuple(false,
+                               std::format("{}:{}:{}: Unable to encode file {}: {}",
+                                           __FILE__,
+                                           __FUNCTION__,
+                                           __LINE__,
+                                           binFile.toStdString(),
+                                           fileOut.errorString().toStdString()));
+    }
+
+    // shared output: on disk before the rename, see writeShared()
+    if (sharedMode && (!fileOut.flush() || ::fsync(fileOut.handle()) != 0))
+    {
+        fileOut.close();
+        fileOut.remove();
+        return std::make_tuple(false,
+                               std::format("{}:{}:{}: Unable to sync file {}",
+                                           __FILE__,
+                                           __FUNCTION__,
+                                           __LINE__,
+                                           tmpFile));
+    }
+    fileOut.close();
+    std::string error;
+    if (sharedMode && !publishFile(tmpFile, binFile.toStdString(), error))
+    {
+        return std::make_tuple(false,
+                               std::format("{}:{}:{}: Unable to publish file {}",
+                                           __FILE__,
+                                           __FUNCTION__,
+                                           __LINE__,
+                                           error));
+    }
+    recordWritten = true;
+    if (auto indexed = indexRecord(targetDir, binFile); !std::get<0>(indexed))
+    {
+        return indexed;
+    }
+    if (feed && !logChange(targetDir, name, std::move(before), recordJson()))
+    {
+        return std::make_tuple(false,
+                               std::format("{}:{}:{}: Unable to append to the change feed of {}",
+                                           __FILE__,
+                                           __FUNCTION__,
+                                           __LINE__,
+                                           binFile.toStdString()));
+    }
+
+    return std::make_tuple(true,
+                           std::format("{}:{}: {}", __FILE__, __FUNCTION__, binFile.toStdString()));
+}
+
+/**
+ * @brief Rz_writeContext::exportedRecord
+ * @return the record as exported in binFile, an empty object if there is none
+ */
+nlohmann::json Rz_writeContext::exportedRecord(const QString &binFile, OutputFormat format) const
+{
+    nlohmann::json doc;
+    QFile file(binFile);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return nlohmann::json::object();
+    }
+    const QByteArray bytes = file.readAll();
+    if (!decodeRecord(format,
+                      reinterpret_cast<const std::uint8_t *>(bytes.constData()),
+                      static_cast<std::size_t>(bytes.size()),
+                      doc))
+    {
+        return nlohmann::json::object();
+    }
+    return doc;
+}
+
+/**
+ * @brief Rz_writeContext::recordJson
+ * @return the current record as it is exported by a full write
+ */
+nlohmann::json Rz_writeContext::recordJson() const
+{
+    const auto &keys = Rz_writeShared::sectionKeys;
+    nlohmann::json doc = nlohmann::json::object();
+    for (const auto &entry : record.section(Rz_section::PICTURE))
+    {
+        const std::string_view key = record.key(entry);
+        if (std::find(keys.begin() + 1, keys.end(), key) == keys.end())
+        {
+            doc[std::string(key)] = std::string(record.value(entry));
+        }
+    }
+    for (std::size_t s = 1; s < Rz_metaRecord::sectionCount; ++s)
+    {
+        nlohmann::json &section = doc[std::string(keys[s])] = nlohmann::json::object();
+        for (const auto &entry : record.section(static_cast<Rz_section>(s)))
+        {
+            section[std::string(record.key(entry))] = std::string(record.value(entry));
+        }
+    }
+    return doc;
+}
+
+/**
+ * @brief Rz_writeContext::logChange
+ * @details appends the delta from before to after to the change feed of the output
+ * folder. Sections of dedup manifests are compared by digest first, only sections of
+ * different digest are decoded from the blob store.
+ * @return false if the delta could not be appended
+ */
+bool Rz_writeContext::logChange(const QString &pathToBinDir,
+                                const std::string &name,
+                                nlohmann::json before,
+                                nlohmann::json after)
+{
+    const std::string dir = QDir(pathToBinDir).absolutePath().toStdString();
+    const auto resolve = [&](const std::string &key, nlohmann::json &doc) {
+        const auto it = doc.find(key);
+        if (it == doc.end() || !it->is_string()
+            || !it->get_ref<const std::string &>().starts_with(Rz_blobStore::referencePrefix))
+        {
+            return;
+        }
+        std::string bytes;
+        nlohmann::json section;
+        const std::string digest = it->get<std::string>().substr(Rz_blobStore::referencePrefix.size());
+        if (Rz_blobStore::open(dir)->get(name, key, outputExtension.toStdString(), digest, bytes)
+            && decodeRecord(static_cast<OutputFormat>(outputFormatFlag),
+                            reinterpret_cast<const std::uint8_t *>(bytes.data()),
+                            bytes.size(),
+                            section))
+        {
+            *it = std::move(section);
+        }
+    };
+    for (std::size_t s = 1; s < Rz_metaRecord::sectionCount; ++s)
+    {
+        const std::string key(Rz_writeShared::sectionKeys[s]);
+        const auto b = before.find(key);
+        const auto a = after.find(key);
+        if (b != before.end() && a != after.end() && b->is_string() && *b == *a)
+        {
+            before.erase(key);
+            after.erase(key);
+            continue;
+        }
+        resolve(key, before);
+        resolve(key, after);
+    }
+
+    const std::string line = Rz_changeLog::entry(name, before, after);
+    if (line.empty())
+    {
+        return true;
+    }
+    if (!changeLog || changeLog->path() != dir + "/" + std::string(Rz_changeLog::fileName))
+    {
+        changeLog = Rz_changeLog::open(dir);
+    }
+    return changeLog->append(line);
+}
+
+/**
+ * @brief Rz_writeContext::updateFile
+ * @details replaces the changed sections of an existing output. Sections of the same
+ * size are patched in place (JSON: also smaller ones, padded with whitespace that
+ * counts to the section in later updates); a section of another size is written
+ * together with the rest of the file behind it, which after an XMP edit are only the
+ * PICTURE fields. Unreadable layouts and sections missing in the output fall back to a
+ * full rewrite. Shared output is never changed in place: the updated file is published
+ * under the lock, see writeShared().
+ * @return <bool, msg string>
+ */
+std::tuple<bool, std::string> Rz_writeContext::updateFile(const QString &binFile, OutputFormat format)
+{
+    // shared output: the read-modify-write holds the lock of this one file
+    QFile file(binFile);
+    std::string lockError;
+    const int lockedFd = sharedMode ? lockOutput(binFile.toStdString(), lockError) : -1;
+    if (sharedMode && lockedFd < 0)
+    {
+        return std::make_tuple(false,
+                               std::format("{}:{}:{}: Unable to lock file {}",
+                                           __FILE__,
+                                           __FUNCTION__,
+                                           __LINE__,
+                                           lockError));
+    }
+    const bool opened = sharedMode ? file.open(lockedFd, QIODevice::ReadWrite, QFileDevice::AutoCloseHandle)
+                                   : file.open(QIODevice::ReadWrite);
+    if (!opened && lockedFd >= 0)
+    {
+        ::close(lockedFd);
+    }
+    if (!opened || file.size() == 0)
+    {
+        return std::make_tuple(false,
+                               std::format("{}:{}:{}: Unable to update file {}: {}",
+                                           __FILE__,
+                                           __FUNCTION__,
+                                           __LINE__,
+                                           binFile.toStdString(),
+                                           file.errorString().toStdString()));
+    }
+    uchar *mapped = file.map(0, file.size());
+    if (mapped == nullptr)
+    {
+        return std::make_tuple(false,
+                               std::format("{}:{}:{}: Unable to map file {}: {}",
+                                           __FILE__,
+                                           __FUNCTION__,
+                                           __LINE__,
+                                           binFile.toStdString(),
+                                           file.errorString().toStdString()));
+    }
+    const std::string_view data(reinterpret_cast<const char *>(mapped),
+                                static_cast<std::size_t>(file.size()));
+
+    struct Patch
+    {
+        std::size_t offset;
+        std::size_t size;
+        std::string bytes;
+    };
+    std::vector<Patch> patches;
+    std::vector<Rz_scanEntry> entries;
+    bool spliceable = scanRecord(format, data, entries);
+
+    for (std::size_t s = 1; s < Rz_metaRecord::sectionCount && spliceable; ++s)
+    {
+        const auto section = static_cast<Rz_section>(s);
+        if (!record.hasSection(section))
+        {
+            continue;
+        }
+        const auto it = std::find_if(entries.begin(), entries.end(), [s](const Rz_scanEntry &entry) {
+            return entry.object && entry.key == Rz_writeShared::sectionKeys[s];
+        });
+        if (it == entries.end())
+        {
+            spliceable = false;
+            break;
+        }
+
+        Patch patch{it->offset, it->size, {}};
+        if (format == OutputFormat::JSON)
+        {
+            // the padding of an earlier shrink belongs to the section, it is reused or
+            // dropped with it instead of piling up in front of the next key
+            std::size_t end = it->offset + it->size;
+            while (end < data.size()
+                   && (data[end] == ' ' || data[end] == '\t' || data[end] == '\n' || data[end] == '\r'))
+            {
+                ++end;
+            }
+            if (end < data.size() && (data[end] == ',' || data[end] == '}'))
+            {
+                patch.size = end - it->offset;
+            }
+        }
+        Rz_metaRecord merged;
+        if (mergeKeys[s]
+            && !mergeSection(format, data.substr(it->offset, it->size), record, section, merged))
+        {
+            spliceable = false;
+            break;
+        }
+        if (!encodeSection(format, mergeKeys[s] ? merged : record, section, patch.bytes))
+        {
+            file.unmap(mapped);
+            return std::make_tuple(false,
+                                   std::format("{}:{}:{}: Unable to encode section {}",
+                                               __FILE__,
+                                               __FUNCTION__,
+                                               __LINE__,
+                                               Rz_writeShared::sectionKeys[s]));
+        }
+        if (format == OutputFormat::JSON && patch.bytes.size() < patch.size)
+        {
+            patch.bytes.append(patch.size - patch.bytes.size(), ' ');
+        }
+        patches.push_back(std::move(patch));
+    }
+
+    if (!spliceable)
+    {
+        std::string out;
+        const bool ok = rewriteRecord(format, data, record, mergeKeys, out);
+        file.unmap(mapped);
+        // shared output: the file stays open, and locked, until the new one is in place
+        QSaveFile save(binFile);
+        if (!ok || !save.open(QIODevice::WriteOnly)
+            || save.write(out.data(), static_cast<qint64>(out.size())) != static_cast<qint64>(out.size())
+            || !save.commit())
+        {
+            return std::make_tuple(false,
+                                   std::format("{}:{}:{}: Unable to rewrite file {}",
+                                               __FILE__,
+                                               __FUNCTION__,
+                                               __LINE__,
+                                               binFile.toStdString()));
+        }
+        recordWritten = true;
+        return std::make_tuple(true,
+                               std::format("{}:{}: {} rewritten",
+                                           __FILE__,
+                                           __FUNCTION__,
+                                           binFile.toStdString()));
+    }
+
+    std::sort(patches.begin(), patches.end(), [](const Patch &lhs, const Patch &rhs) {
+        return lhs.offset < rhs.offset;
+    });
+    const auto moving = std::find_if(patches.begin(), patches.end(), [](const Patch &patch) {
+        return patch.bytes.size() != patch.size;
+    });
+
+    // everything behind the first section of another size, with the new sections
+    std::string tail;
+    const std::size_t tailOffset = moving != patches.end() ? moving->offset : data.size();
+    if (moving != patches.end())
+    {
+        std::size_t pos = tailOffset;
+        for (auto patch = moving; patch != patches.end(); ++patch)
+        {
+            tail.append(data.substr(pos, patch->offset - pos));
+            tail.append(patch->bytes);
+            pos = patch->offset + patch->size;
+        }
+        tail.append(data.substr(pos));
+    }
+
+    if (sharedMode)
+    {
+        // readers take no lock: the updated file is published as a whole, the lock of
+        // the old one is held until the new one is in place
+        std::string out(data.substr(0, tailOffset));
+        file.unmap(mapped);
+        for (auto patch = patches.begin(); patch != moving; ++patch)
+        {
+            out.replace(patch->offset, patch->size, patch->bytes);
+        }
+        out.append(tail);
+        if (format == OutputFormat::BSON)
+        {
+            // document size, int32 little endian
+            for (std::size_t i = 0; i < 4; ++i)
+            {
+                out[i] = static_cast<char>((out.size() >> (8 * i)) & 0xFF);
+            }
+        }
+        std::string error;
+        const bool published = writeShared(binFile.toStdString(), out, error);
+        file.close();
+        if (!published)
+        {
+            return std::make_tuple(false,
+                                   std::format("{}:{}:{}: Unable to publish file {}",
+                                               __FILE__,
+                                               __FUNCTION__,
+                                               __LINE__,
+                                               error));
+        }
+        recordWritten = true;
+        return std::make_tuple(true,
+                               std::format("{}:{}: {} updated, {} bytes written",
+                                           __FILE__,
+                                           __FUNCTION__,
+                                           binFile.toStdString(),
+                                           out.size()));
+    }
+    file.unmap(mapped);
+
+    bool ok = true;
+    for (auto patch = patches.begin(); patch != moving && ok; ++patch)
+    {
+        ok = file.seek(static_cast<qint64>(patch->offset))
+             && file.write(patch->bytes.data(), static_cast<qint64>(patch->bytes.size()))
+                    == static_cast<qint64>(patch->bytes.size());
+    }
+    if (ok && moving != patches.end())
+    {
+        const qint64 newSize = static_cast<qint64>(tailOffset + tail.size());
+        ok = file.seek(static_cast<qint64>(tailOffset))
+             && file.write(tail.data(), static_cast<qint64>(tail.size())) == static_cast<qint64>(tail.size())
+             && file.resize(newSize);
+        if (ok && format == OutputFormat::BSON)
+        {
+            // document size, int32 little endian
+            const std::array<char, 4> size{static_cast<char>(newSize & 0xFF),
+                                           static_cast<char>((newSize >> 8) & 0xFF),
+                                           static_cast<char>((newSize >> 16) & 0xFF),
+                                           static_cast<char>((newSize >> 24) & 0xFF)};
+            ok = file.seek(0) && file.write(size.data(), 4) == 4;
+        }
+    }
+    file.close();
+
+    if (!ok)
+    {
+        return std::make_tuple(false,
+                               std::format("{}:{}:{}: Unable to update file {}: {}",
+                                           __FILE__,
+                                           __FUNCTION__,
+                                           __LINE__,
+                                           binFile.toStdString(),
+                                           file.errorString().toStdString()));
+    }
+    recordWritten = true;
+
+    return std::make_tuple(true,
+                           std::format("{}:{}: {} updated, {} bytes written",
+                                       __FILE__,
+                                       __FUNCTION__,
+                                       binFile.toStdString(),
+                                       tail.size() + std::accumulate(patches.begin(), moving, std::size_t{0},
+                                                                     [](std::size_t sum, const Patch &patch) {
+                                                                         return sum + patch.bytes.size();
+                                                                     })));
+}
+
+/**
+ * @brief Rz_writeContext::enqueueStriped
+ * @details encodes the record and hands it to the writer queue of its root; write
+ * errors are reported by doRun("flush") and doClose()
+ * @return <bool, msg string>
+ */
+std::tuple<bool, std::string> Rz_writeContext::enqueueStriped(std::size_t stripe, OutputFormat format)
+{
+    SectionNodes sections;
+    std::vector<Rz_streamEncoder::Node> root;
+    recordNodes(record, sections, root);
+    Rz_bufferSink sink;
+    Rz_streamEncoder encoder(format, sink);
+    bool ok = encoder.encode(root);
+    if (ok && format == OutputFormat::JSON)
+    {
+        ok = encoder.write("\n", 1);
+    }
+    ok = encoder.flush() && ok;
+    if (!ok)
+    {
+        return std::make_tuple(false,
+                               std::format("{}:{}:{}: Unable to encode {}",
+                                           __FILE__,
+                                           __FUNCTION__,
+                                           __LINE__,
+                                           imgStruct.fileBasename.toStdString()));
+    }
+
+    const QString fileName = imgStruct.fileBasename + outputExtension;
+    stripeWriters[stripe]->enqueue(fileName.toStdString(), std::move(sink.data), stripeBatches[stripe], sharedMode);
+    recordWritten = true;
+
+    const QString &targetDir = stripeRoots[static_cast<qsizetype>(stripe)];
+    if (auto indexed = indexRecord(targetDir, targetDir + "/" + fileName); !std::get<0>(indexed))
+    {
+        return indexed;
+    }
+
+    return std::make_tuple(true,
+                           std::format("{}:{}: {}/{} queued",
+                                       __FILE__,
+                                       __FUNCTION__,
+                                       targetDir.toStdString(),
+                                       fileName.toStdString()));
+}
+
+/**
+ * @brief Rz_writeContext::drainStripe
+ * @details waits until the files queued by this context into the stripe are written,
+ * then journals and logs the changes of those written
+ * @return the errors of the stripe, empty if none
+ */
+std::string Rz_writeContext::drainStripe(std::size_t stripe)
+{
+    std::string errors;
+    const auto &writer = stripeWriters[stripe];
+    std::string error;
+    std::vector<std::string> failed;
+    if (!writer->drain(*stripeBatches[stripe], failed, error))
+    {
+        errors += std::format(" {}: {};", writer->path(), error);
+    }
+    const auto written = [&failed](const std::string &fileName) {
+        return std::find(failed.begin(), failed.end(), fileName) == failed.end();
+    };
+    const QString &root = stripeRoots[static_cast<qsizetype>(stripe)];
+
+    // files that failed are written again on resume
+    checkpointQueued.resize(stripeWriters.size());
+    if (!checkpointQueued[stripe].empty())
+    {
+        const auto journal = checkpointOf(root);
+        for (const auto &name : checkpointQueued[stripe])
+        {
+            if (written(name))
+            {
+                journal->complete(name);
+            }
+        }
+    }
+    checkpointQueued[stripe].clear();
+
+    // files that failed keep their previous record, they have no delta
+    changesQueued.resize(stripeWriters.size());
+    for (auto &change : changesQueued[stripe])
+    {
+        if (written(change.fileName)
+            && !logChange(root, change.record, std::move(change.before), std::move(change.after)))
+        {
+            errors += std::format(" {}: Unable to append to the change feed;", change.fileName);
+        }
+    }
+    changesQueued[stripe].clear();
+    return errors;
+}
+
+/**
+ * @brief Rz_writeContext::drainStripes
+ * @details waits until the files queued by this context are written, other contexts
+ * writing into the same roots aren't waited for
+ * @return <bool, msg string>
+ */
+std::tuple<bool, std::string> Rz_writeContext::drainStripes()
+{
+    // errors of stripes drained before an update
+    std::string errors = std::exchange(stripeErrors, std::string());
+    for (std::size_t i = 0; i < stripeWriters.size(); ++i)
+    {
+        errors += drainStripe(i);
+    }
+    if (!errors.empty())
+    {
+        return std::make_tuple(false, std::format("{}:{}:{}:{}", __FILE__, __FUNCTION__, __LINE__, errors));
+    }
+    return std::make_tuple(true, std::format("{}:{}:{}: flushed", __FILE__, __FUNCTION__, __LINE__));
+}
+
+bool Rz_writeContext::openArchive()
+{
+    if (archiveDir.isEmpty())
+    {
+        return false;
+    }
+    const std::string dir = archiveDir.toStdString();
+    if (!archive || archive->path() != dir)
+    {
+        archive = Rz_archive::open(dir, sharedMode);
+    }
+    archive->setDirectIo(directIo);
+    return archive->isOpen();
+}
+
+/**
+ * @brief Rz_writeContext::writeDeduplicated
+ * @details stores EXIF, IPTC and XMP in the blob store of the output folder, canonically
+ * encoded (keys sorted, duplicates resolved, so equal sections give equal bytes), and
+ * writes the per-image manifest: the PICTURE fields and "sha256:<digest>" per section.
+ * Every record is complete, the update mode doesn't apply.
+ * @return <bool, msg string>
+ */
+std::tuple<bool, std::string> Rz_writeContext::writeDeduplicated(const QString &pathToBinDir,
+                                                                 const QString &binFile,
+                                                                 OutputFormat format)
+{
+    dedupDir = QDir(pathToBinDir).absolutePath();
+    const std::string dir = dedupDir.toStdString();
+    if (!blobStore || blobStore->path() != dir + "/" + std::string(Rz_blobStore::directoryName))
+    {
+        blobStore = Rz_blobStore::open(dir);
+    }
+
+    const std::string name = imgStruct.fileBasename.toStdString();
+    const std::string extension = outputExtension.toStdString();
+    std::array<std::string, Rz_metaRecord::sectionCount> references;
+    std::string bytes;
+    std::string digest;
+    std::string error;
+    for (std::size_t s = 1; s < Rz_metaRecord::sectionCount; ++s)
+    {
+        const auto &key = Rz_writeShared::sectionKeys[s];
+        if (!encodeSection(format, record, static_cast<Rz_section>(s), bytes)
+            || !blobStore->put(name, key, extension, bytes, digest, error))
+        {
+            return std::make_tuple(false,
+                                   std::format("{}:{}:{}: Unable to store section {} of {}: {}",
+                                               __FILE__,
+                                               __FUNCTION__,
+                                               __LINE__,
+                                               key,
+                                               name,
+                                               error));
+        }
+        references[s] = std::string(Rz_blobStore::referencePrefix) + digest;
+    }
+
+    // the record with the sections replaced by their references
+    SectionNodes sections;
+    std::vector<Rz_streamEncoder::Node> root;
+    recordNodes(record, sections, root);
+    for (auto &node : root)
+    {
+        for (std::size_t s = 1; s < Rz_metaRecord::sectionCount; ++s)
+        {
+            if (node.children == &sections[s])
+            {
+                node.value = std::string_view(references[s]);
+                node.children = nullptr;
+            }
+        }
+    }
+    Rz_bufferSink sink;
+    Rz_streamEncoder encoder(format, sink);
+    bool ok = encoder.encode(root);
+    if (ok && format == OutputFormat::JSON)
+    {
+        ok = encoder.write("\n", 1);
+    }
+    ok = encoder.flush() && ok;
+    if (!ok || !writeShared(binFile.toStdString(), sink.data, error))
+    {
+        return std::make_tuple(false,
+                               std::format("{}:{}:{}: Unable to write manifest {}: {}",
+                                           __FILE__,
+                                           __FUNCTION__,
+                                           __LINE__,
+                                           binFile.toStdString(),
+                                           error));
+    }
+    recordWritten = true;
+    if (auto indexed = indexRecord(pathToBinDir, binFile); !std::get<0>(indexed))
+    {
+        return indexed;
+    }
+
+    return std::make_tuple(true,
+                           std::format("{}:{}: {}", __FILE__, __FUNCTION__, binFile.toStdString()));
+}
+
+/**
+ * @brief Rz_writeContext::appendToArchive
+ * @details appends the encoded record to the archive in the output folder, the file
+ * basename is the key; the update mode doesn't apply, every record is complete
+ * @return <bool, msg string>
+ */
+std::tuple<bool, std::string> Rz_writeContext::appendToArchive(const QString &pathToBinDir, OutputFormat format)
+{
+    archiveDir = QDir(pathToBinDir).absolutePath();
+    if (!openArchive())
+    {
+        return std::make_tuple(false,
+                               std::format("{}:{}:{}: Unable to open archive {}",
+                                           __FILE__,
+                                           __FUNCTION__,
+                                           __LINE__,
+                                           archiveDir.toStdString()));
+    }
+
+    SectionNodes sections;
+    std::vector<Rz_streamEncoder::Node> root;
+    recordNodes(record, sections, root);
+    Rz_bufferSink sink;
+    Rz_streamEncoder encoder(format, sink);
+    if (!encoder.encode(root) || !encoder.flush()
+        || !archive->append(imgStruct.fileBasename.toStdString(), format, sink.data))
+    {
+        return std::make_tuple(false,
+                               std::format("{}:{}:{}: Unable to append {} to archive {}",
+                                           __FILE__,
+                                           __FUNCTION__,
+                                           __LINE__,
+                                           imgStruct.fileBasename.toStdString(),
+                                           archiveDir.toStdString()));
+    }
+    recordWritten = true;
+    if (auto indexed = indexRecord(pathToBinDir, QString()); !std::get<0>(indexed))
+    {
+        return indexed;
+    }
+
+    return std::make_tuple(true,
+                           std::format("{}:{}: {} appended to {}",
+                                       __FILE__,
+                                       __FUNCTION__,
+                                       imgStruct.fileBasename.toStdString(),
+                                       archiveDir.toStdString()));
+}
+
+bool Rz_writeContext::setIndexFields(const QList<QString> &fields)
+{
+    std::vector<IndexField> parsed;
+    for (const auto &field : fields)
+    {
+        const qsizetype dot = field.indexOf('.');
+        const auto section = sectionFromType(field.left(dot));
+        if (dot <= 0 || !section)
+        {
+            return false;
+        }
+        parsed.push_back({field.toStdString(), *section, field.mid(dot + 1).toStdString()});
+    }
+    indexFields = std::move(parsed);
+    return true;
+}
+
+/**
+ * @brief Rz_writeContext::indexRecord
+ * @details adds the indexed fields of the written record to the search index; sections
+ * missing in the record (update mode) are read back from the output
+ * @return <bool, msg string>
+ */
+std::tuple<bool, std::string> Rz_writeContext::indexRecord(const QString &pathToBinDir, const QString &binFile)
+{
+    if (!indexEnabled)
+    {
+        return std::make_tuple(true, std::format("{}:{}", __FILE__, __FUNCTION__));
+    }
+    indexDir = QDir(pathToBinDir).absolutePath();
+    const std::string indexPath = indexDir.toStdString() + "/" + std::string(Rz_searchIndex::fileName);
+    if (!searchIndex || searchIndex->path() != indexPath)
+    {
+        searchIndex = Rz_searchIndex::open(indexDir.toStdString());
+    }
+
+    nlohmann::json output;
+    const bool complete = std::all_of(indexFields.begin(), indexFields.end(), [this](const IndexField &field) {
+        return record.hasSection(field.section);
+    });
+    if (!complete)
+    {
+        QFile file(binFile);
+        if (file.open(QIODevice::ReadOnly))
+        {
+            const QByteArray bytes = file.readAll();
+            decodeRecord(static_cast<OutputFormat>(outputFormatFlag),
+                         reinterpret_cast<const std::uint8_t *>(bytes.constData()),
+                         static_cast<std::size_t>(bytes.size()),
+                         output);
+        }
+    }
+
+    std::vector<Rz_searchIndex::Field> fields;
+    for (const auto &field : indexFields)
+    {
+        if (record.hasSection(field.section))
+        {
+            if (const auto value = record.find(field.section, field.key))
+            {
+                fields.emplace_back(field.name, *value);
+            }
+            continue;
+        }
+        const auto &sectionKey = Rz_writeShared::sectionKeys[static_cast<std::size_t>(field.section)];
+        const auto section = output.find(std::string(sectionKey));
+        if (section != output.end() && section->is_object())
+        {
+            const auto value = section->find(field.key);
+            if (value != section->end() && value->is_string())
+            {
+                fields.emplace_back(field.name, value->get_ref<const std::string &>());
+            }
+        }
+    }
+    if (!searchIndex->add(imgStruct.fileBasename.toStdString(), fields))
+    {
+        return std::make_tuple(false,
+                               std::format("{}:{}:{}: Unable to write the search index {}",
+                                           __FILE__,
+                                           __FUNCTION__,
+                                           __LINE__,
+                                           indexPath));
+    }
+    return std::make_tuple(true, std::format("{}:{}", __FILE__, __FUNCTION__));
+}
+
+/**
+ * @brief Rz_writeContext::search
+ * @details records containing all tokens of the query in any of the indexed fields;
+ * the records not yet flushed are searched in memory
+ */
+QList<QString> Rz_writeContext::search(const QString &query)
+{
+    QList<QString> found;
+    if (!searchIndex)
+    {
+        return found;
+    }
+
+    std::vector<std::string> tokens;
+    Rz_searchIndex::tokenize(query.toStdString(), tokens);
+    std::vector<std::vector<std::string>> terms(tokens.size());
+    for (std::size_t t = 0; t < tokens.size(); ++t)
+    {
+        for (const auto &field : indexFields)
+        {
+            terms[t].push_back(Rz_searchIndex::term(field.name, tokens[t]));
+        }
+    }
+    const std::vector<std::string> names = searchIndex->search(terms);
+
+    found.reserve(static_cast<qsizetype>(names.size()));
+    for (const auto &name : names)
+    {
+        found.append(QString::fromStdString(name));
+    }
+    return found;
+}
+
+/**
+ * @brief Rz_writeContext::doRun
+ *
+ * @param type <"compact[:<MB/s>]", "remove", "flush", "collect", "checkpoint">
+ * @details
+ * - "flush": waits until the queued files of the striped output are written, then
+ *   flushes the checkpoint journals
+ * - "checkpoint": appends the records completed so far to the checkpoint journals
+ * - "compact": compacts the archive in the background, throttled to the given write
+ *   rate (default 32 MB/s, 0 = unlimited); the result is returned by getQstring("compact")
+ * - "remove": removes the record of imgStruct from the archive; with "dedup" its
+ *   manifest and its references to the stored sections
+ * - "collect": removes the stored sections no manifest refers to anymore
+ * @return std::tuple<bool, std::string>
+ */
+std::tuple<bool, std::string> Rz_writeContext::doRun(const QString &type)
+{
+    if (type.contains("flush"))
+    {
+        const auto drained = drainStripes();
+        if (!flushCheckpoints())
+        {
+            return std::make_tuple(false,
+                                   std::format("{}:{}:{}: Unable to write the checkpoint journal",
+                                               __FILE__,
+                                               __FUNCTION__,
+                                               __LINE__));
+        }
+        return drained;
+    }
+
+    if (type.contains("checkpoint"))
+    {
+        return std::make_tuple(flushCheckpoints(),
+                               std::format("{}:{}:{}: checkpoint", __FILE__, __FUNCTION__, __LINE__));
+    }
+
+    if (type.startsWith("compact"))
+    {
+        if (!openArchive())
+        {
+            return std::make_tuple(false,
+                                   std::format("{}:{}:{}: no archive", __FILE__, __FUNCTION__, __LINE__));
+        }
+        bool isNumber = false;
+        const double rate = type.section(':', 1, 1).toDouble(&isNumber);
+        const double megabytes = isNumber && rate >= 0 ? rate : defaultCompactRate;
+        if (!archive->startCompaction(static_cast<std::uint64_t>(megabytes * 1024 * 1024)))
+        {
+            return std::make_tuple(false,
+                                   std::format("{}:{}:{}: compaction already running",
+                                               __FILE__,
+                                               __FUNCTION__,
+                                               __LINE__));
+        }
+        return std::make_tuple(true,
+                               std::format("{}:{}:{}: compaction started, {} MB/s",
+                                           __FILE__,
+                                           __FUNCTION__,
+                                           __LINE__,
+                                           megabytes));
+    }
+
+    if (type.contains("collect"))
+    {
+        if (dedupDir.isEmpty())
+        {
+            return std::make_tuple(false,
+                                   std::format("{}:{}:{}: no blob store", __FILE__, __FUNCTION__, __LINE__));
+        }
+        blobStore = Rz_blobStore::open(dedupDir.toStdString());
+        return std::make_tuple(true,
+                               std::format("{}:{}:{}: {} unreferenced sections removed",
+                                           __FILE__,
+                                           __FUNCTION__,
+                                           __LINE__,
+                                           blobStore->collect()));
+    }
+
+    if (type.contains("remove") && dedupEnabled)
+    {
+        const std::string name = imgStruct.fileBasename.toStdString();
+        bool ok = !dedupDir.isEmpty();
+        if (ok)
+        {
+            // the manifest first: a reader never finds a manifest without its sections
+            QFile::remove(dedupDir + "/" + imgStruct.fileBasename + outputExtension);
+            blobStore = Rz_blobStore::open(dedupDir.toStdString());
+            for (std::size_t s = 1; s < Rz_metaRecord::sectionCount; ++s)
+            {
+                ok = blobStore->release(name, Rz_writeShared::sectionKeys[s], outputExtension.toStdString()) && ok;
+            }
+            if (changeFeed)
+            {
+                ok = Rz_changeLog::open(dedupDir.toStdString())->append(Rz_changeLog::removal(name)) && ok;
+            }
+        }
+        return std::make_tuple(ok,
+                               std::format("{}:{}:{}: {} {}",
+                                           __FILE__,
+                                           __FUNCTION__,
+                                           __LINE__,
+                                           name,
+                                           ok ? "removed" : "not removed"));
+    }
+
+    if (type.contains("remove"))
+    {
+        if (!openArchive() || !archive->remove(imgStruct.fileBasename.toStdString()))
+        {
+            return std::make_tuple(false,
+                                   std::format("{}:{}:{}: Unable to remove {}",
+                                               __FILE__,
+                                               __FUNCTION__,
+                                               __LINE__,
+                                               imgStruct.fileBasename.toStdString()));
+        }
+        return std::make_tuple(true,
+                               std::format("{}:{}:{}: {} removed",
+                                           __FILE__,
+                                           __FUNCTION__,
+                                           __LINE__,
+                                           imgStruct.fileBasename.toStdString()));
+    }
+
+    return std::make_tuple(true, std::format("{}:{}", __FILE__, __FUNCTION__));
+}
+
+std::tuple<bool, std::string> Rz_writeContext::doClose(const QString &type)
+{
+    const auto drained = drainStripes();
+    stripeWriters.clear();
+    stripeBatches.clear();
+    stripeRoots.clear();
+    checkpointQueued.clear();
+    changesQueued.clear();
+    flushCheckpoints();
+    checkpoints.clear();
+    closeParsed();
+    record.release();
+    mergeKeys.fill(false);
+    recordWritten = false;
+    const bool indexed = !searchIndex || searchIndex->flush();
+    searchIndex.reset();
+    // the last context of an archive waits for a running compaction
+    archive.reset();
+    if (!std::get<0>(drained))
+    {
+        return drained;
+    }
+    if (!indexed)
+    {
+        return std::make_tuple(false,
+                               std::format("{}:{}:{}: Unable to write the search index", __FILE__, __FUNCTION__, __LINE__));
+    }
+    return std::make_tuple(true, std::format("{}:{}", __FILE__, __FUNCTION__));
+}
+
+/**
+ * @brief Rz_writeContext::setQstring
+ *
+ * @param string <"">
+ * @param type <"imgStruct", "update", "JSON", "CBOR", "MSGPACK", "UBJSON", "BSON", "BJDATA">
+ * @details
+ * - "imgStruct": set imageStruct data from given string (full path to image)
+ * - "update": string "on"/"true"/"1" switches the update mode on, everything else off
+ * - "shared": string "on"/"true"/"1": other processes write into the same output tree;
+ *   files are written under a name of their own and renamed into place, updates lock
+ *   the file, archive appends are single O_APPEND frames (the search index stays per
+ *   process, enable it in one process only)
+ * - "lazy": string "on"/"true"/"1": parseFile() keeps the file mapped and decodes
+ *   sections on request
+ * - "indexDir": directory of the search index for getQList("search:..."), default the
+ *   output directory of the last writeFile()
+ * - "index": string "on"/"true"/"1" adds every written record to the search index
+ *   (".rz_search.idx" and its delta segments ".rz_search.idx.<n>" in the output directory)
+ * - "archiveDir": archive of doRun("compact") and doRun("remove"), default the output
+ *   directory of the last writeFile()
+ * - "archive": string "on"/"true"/"1" appends the records to the archive in the output
+ *   directory instead of writing one file per image
+ * - "cache": string <MB> or "on" (64 MB): memory cap of the record cache of
+ *   parseFile(), shared by all contexts of the process; "off"/"0" drops it
+ * - "checkpoint": string "on"/"true"/"1" keeps the checkpoint journal ".rz_checkpoint"
+ *   of the output folder; writeFile() skips the output files completed by an earlier
+ *   run (not in update mode), remove the journal to export the folder again
+ * - "changes": string "on"/"true"/"1" appends the delta of every written record to the
+ *   change feed ".rz_changes.log" of the output folder (JSON Lines, JSON Patch against
+ *   the previous export; not for the archive)
+ * - "direct": string "on"/"true"/"1": the archive is written past the page cache,
+ *   compacted segments with O_DIRECT, appends with write-behind
+ * - "dedupDir": output folder of doRun("remove") and doRun("collect") with "dedup",
+ *   default the output directory of the last writeFile()
+ * - "dedup": string "on"/"true"/"1" stores EXIF, IPTC and XMP once per content in
+ *   ".rz_blobs" of the output folder, the output file of an image is a manifest
+ *   referring to them; parseFile() reassembles the full record
+ * - "JSON": set output format to JSON
+ * - "CBOR": set output format to CBOR
+ * - "MSGPACK": set output format to MsgPack
+ * - "UBJSON": set output format to UBJSON
+ * - "BSON": set output format to BSON
+ * - "BJDATA": set output format to BJData
+ * @return std::tuple<bool, std::string>
+ */
+std::tuple<bool, std::string> Rz_writeContext::setQstring(const QString &string, const QString &type)
+{
+    if (type.contains("imgStruct"))
+    {
+        QFileInfo fileInfo(string);
+
+        imgStruct.fileName = fileInfo.fileName();
+        imgStruct.fileBasename = fileInfo.completeBaseName();
+        imgStruct.fileSuffix = fileInfo.completeSuffix();
+        imgStruct.fileAbolutePath = fileInfo.absolutePath();
+        imgStruct.homePath = QDir::homePath();
+        return std::make_tuple(true,
+                               std::format("{}:{}:{}: imgStruct", __FILE__, __FUNCTION__, __LINE__));
+    }
+
+    if (type.contains("archiveDir"))
+    {
+        archiveDir = QDir(string).absolutePath();
+        return std::make_tuple(true,
+                               std::format("{}:{}:{}: archiveDir", __FILE__, __FUNCTION__, __LINE__));
+    }
+
+    if (type.contains("cache"))
+    {
+        bool isNumber = false;
+        const double megabytes = string.toDouble(&isNumber);
+        const bool on = string.compare("on", Qt::CaseInsensitive) == 0
+                        || string.compare("true", Qt::CaseInsensitive) == 0;
+        const double size = isNumber && megabytes > 0 ? megabytes : on ? defaultCacheSize : 0.0;
+        Rz_recordCache::instance().setCapacity(static_cast<std::size_t>(size * 1024 * 1024));
+        return std::make_tuple(true,
+                               std::format("{}:{}:{}: cache: {} MB", __FILE__, __FUNCTION__, __LINE__, size));
+    }
+
+    if (type.contains("checkpoint"))
+    {
+        checkpointEnabled = string == "1" || string.compare("on", Qt::CaseInsensitive) == 0
+                            || string.compare("true", Qt::CaseInsensitive) == 0;
+        return std::make_tuple(true,
+                               std::format("{}:{}:{}: checkpoint: {}",
+                                           __FILE__,
+                                           __FUNCTION__,
+                                           __LINE__,
+                                           checkpointEnabled ? "on" : "off"));
+    }
+
+    if (type.contains("changes"))
+    {
+        changeFeed = string == "1" || string.compare("on", Qt::CaseInsensitive) == 0
+                     || string.compare("true", Qt::CaseInsensitive) == 0;
+        return std::make_tuple(true,
+                               std::format("{}:{}:{}: changes: {}",
+                                           __FILE__,
+                                           __FUNCTION__,
+                                           __LINE__,
+                                           changeFeed ? "on" : "off"));
+    }
+
+    if (type.contains("direct"))
+    {
+        directIo = string == "1" || string.compare("on", Qt::CaseInsensitive) == 0
+                   || string.compare("true", Qt::CaseInsensitive) == 0;
+        return std::make_tuple(true,
+                               std::format("{}:{}:{}: direct: {}",
+                                           __FILE__,
+                                           __FUNCTION__,
+                                           __LINE__,
+                                           directIo ? "on" : "off"));
+    }
+
+    if (type.contains("archive"))
+    {
+        archiveEnabled = string == "1" || string.compare("on", Qt::CaseInsensitive) == 0
+                         || string.compare("true", Qt::CaseInsensitive) == 0;
+        return std::make_tuple(true,
+                               std::format("{}:{}:{}: archive: {}",
+                                           __FILE__,
+                                           __FUNCTION__,
+                                           __LINE__,
+                                           archiveEnabled ? "on" : "off"));
+    }
+
+    if (type.contains("indexDir"))
+    {
+        indexDir = QDir(string).absolutePath();
+        return std::make_tuple(true,
+                               std::format("{}:{}:{}: indexDir", __FILE__, __FUNCTION__, __LINE__));
+    }
+
+    if (type.contains("index"))
+    {
+        indexEnabled = string == "1" || string.compare("on", Qt::CaseInsensitive) == 0
+                       || string.compare("true", Qt::CaseInsensitive) == 0;
+        return std::make_tuple(true,
+                               std::format("{}:{}:{}: index: {}",
+                                           __FILE__,
+                                           __FUNCTION__,
+                                           __LINE__,
+                                           indexEnabled ? "on" : "off"));
+    }
+
+    if (type.contains("dedupDir"))
+    {
+        dedupDir = QDir(string).absolutePath();
+        return std::make_tuple(true,
+                               std::format("{}:{}:{}: dedupDir", __FILE__, __FUNCTION__, __LINE__));
+    }
+
+    if (type.contains("dedup"))
+    {
+        dedupEnabled = string == "1" || string.compare("on", Qt::CaseInsensitive) == 0
+                       || string.compare("true", Qt::CaseInsensitive) == 0;
+        return std::make_tuple(true,
+                               std::format("{}:{}:{}: dedup: {}",
+                                           __FILE__,
+                                           __FUNCTION__,
+                                           __LINE__,
+                                           dedupEnabled ? "on" : "off"));
+    }
+
+    if (type.contains("shared"))
+    {
+        sharedMode = string == "1" || string.compare("on", Qt::CaseInsensitive) == 0
+                     || string.compare("true", Qt::CaseInsensitive) == 0;
+        archive.reset();
+        return std::make_tuple(true,
+                               std::format("{}:{}:{}: shared: {}",
+                                           __FILE__,
+                                           __FUNCTION__,
+                                           __LINE__,
+                                           sharedMode ? "on" : "off"));
+    }
+
+    if (type.contains("lazy"))
+    {
+        lazyMode = string == "1" || string.compare("on", Qt::CaseInsensitive) == 0
+                   || string.compare("true", Qt::CaseInsensitive) == 0;
+        return std::make_tuple(true,
+                               std::format("{}:{}:{}: lazy: {}",
+                                           __FILE__,
+                                           __FUNCTION__,
+                                           __LINE__,
+                                           lazyMode ? "on" : "off"));
+    }
+
+    if (type.contains("update"))
+    {
+        updateMode = string == "1" || string.compare("on", Qt::CaseInsensitive) == 0
+                     || string.compare("true", Qt::CaseInsensitive) == 0;
+        return std::make_tuple(true,
+                               std::format("{}:{}:{}: update: {}",
+                                           __FILE__,
+                                           __FUNCTION__,
+                                           __LINE__,
+                                           updateMode ? "on" : "off"));
+    }
+
+    auto fmt = enumFromString(type);
+    if (fmt)
+    {
+        outputFormatFlag = static_cast<int>(*fmt);
+        outputExtension = extensionFromEnum(*fmt);
+
+        return std::make_tuple(false,
+                               std::format("{}:{}:{}: type: {}",
+                                           __FILE__,
+                                           __FUNCTION__,
+                                           __LINE__,
+                                           outputFormatFlag));
+    }
+    else
+    {
+        outputFormatFlag = -0;
+        outputExtension = ".unknown";
+        return std::make_tuple(false,
+                               std::format("{}:{}:{}: unknown type: {}",
+                                           __FILE__,
+                                           __FUNCTION__,
+                                           __LINE__,
+                                           type.toStdString()));
+    }
+
+    /*
+
+    auto fmt = formatFromExtension(type);
+
+    if (fmt.has_value())
+    {
+        outputFormatFlag << static_cast<int>(*fmt);
+        outputExtension = outputFormats.extension(*fmt);
+
+        return std::make_tuple(false,
+                               std::format("{}:{}:{}: type: {}",
+                                           __FILE__,
+                                           __FUNCTION__,
+                                           __LINE__,
+                                           outputFormatFlag));
+    }
+    else
+    {
+        return std::make_tuple(false,
+                               std::format("{}:{}:{}: unknown type: {}",
+                                           __FILE__,
+                                           __FUNCTION__,
+                                           __LINE__,
+                                           type.toStdString()));
+    }
+
+    if (outputExtension.isEmpty())
+    {
+        return std::make_tuple(false,
+                               std::format("{}:{}:{}: {}", __FILE__, __FUNCTION__, __LINE__, type.toStdString()));
+    }
+*/
+    return std::make_tuple(false, std::format("{}:{}: wrong paramater", __FILE__, __FUNCTION__));
+}
+
+/**
+ * @brief Rz_writeContext::getQstring
+ *
+ * @param type <"compact", "stripe:<file basename>", "key:<SECTION>.<key>">
+ * @details
+ * - "key:<SECTION>.<key>": one value, e.g. "key:EXIF.gpslatitude"; in lazy mode only
+ *   this key is decoded from the parsed file
+ * - "compact": "running" or the result of the last compaction of the archive
+ * - "stripe:<file basename>": output root holding the image, empty without striping
+ * - "checkpoint:<output folder>": records resumed, completed and skipped in the folder,
+ *   empty if this context has no checkpoint journal open there
+ * - "cache": hits, misses, evictions and size of the record cache
+ * - "dedup": sections stored and deduplicated by the blob store
+ * @return QString
+ */
+QString Rz_writeContext::getQstring(const QString &type)
+{
+    if (type.startsWith("key:"))
+    {
+        return parsedValue(type.mid(4));
+    }
+    if (type.startsWith("stripe:"))
+    {
+        if (stripeRoots.isEmpty())
+        {
+            return "";
+        }
+        const std::size_t stripe = Rz_stripeWriter::stripeOf(type.mid(7).toStdString(),
+                                                             static_cast<std::size_t>(stripeRoots.size()));
+        return stripeRoots[static_cast<qsizetype>(stripe)];
+    }
+
+    if (type.startsWith("checkpoint:"))
+    {
+        // only journals in use, a report doesn't create one
+        const auto journal = checkpoints.value(QDir(type.mid(11)).absolutePath());
+        return journal ? QString::fromStdString(journal->report()) : QString();
+    }
+
+    if (type.contains("cache"))
+    {
+        return QString::fromStdString(Rz_recordCache::instance().report());
+    }
+
+    if (type.contains("dedup"))
+    {
+        return blobStore ? QString::fromStdString(blobStore->report()) : QString();
+    }
+
+    if (type.contains("compact") && openArchive())
+    {
+        return archive->compacting() ? QStringLiteral("running")
+                                     : QString::fromStdString(archive->report());
+    }
+    return "";
+}
+
+/**
+ * @brief Rz_writeContext::setQList
+ *
+ * @param stringList <fields, e.g. "XMP.keywords", "IPTC.caption"> or <output roots>
+ * @param type <"indexFields", "stripeRoots">
+ * @details
+ * - "indexFields": fields of the search index, default XMP keywords, city,
+ *   countryname, title and IPTC caption
+ * - "stripeRoots": output roots, writeFile() writes each record into the root chosen
+ *   by a stable hash of its file basename (see getQstring("stripe:...")), each root
+ *   has its own writer thread; an empty list switches striping off
+ * @return std::tuple<bool, std::string>
+ */
+std::tuple<bool, std::string> Rz_writeContext::setQList(const QList<QString> &stringList,
+                                                     const QString &type)
+{
+    if (type.contains("stripeRoots"))
+    {
+        const auto drained = drainStripes();
+        stripeWriters.clear();
+        stripeBatches.clear();
+        stripeRoots.clear();
+        for (const auto &root : stringList)
+        {
+            stripeRoots.append(QDir(root).absolutePath());
+            stripeWriters.push_back(Rz_stripeWriter::open(stripeRoots.last().toStdString()));
+            stripeBatches.push_back(std::make_shared<Rz_stripeWriter::Batch>());
+        }
+        if (!std::get<0>(drained))
+        {
+            return drained;
+        }
+        return std::make_tuple(true,
+                               std::format("{}:{}:{}: stripeRoots: {}",
+                                           __FILE__,
+                                           __FUNCTION__,
+                                           __LINE__,
+                                           stripeRoots.size()));
+    }
+
+    if (type.contains("indexFields"))
+    {
+        if (!setIndexFields(stringList))
+        {
+            return std::make_tuple(false,
+                                   std::format("{}:{}:{}: wrong field, expected <SECTION>.<key>",
+                                               __FILE__,
+                                               __FUNCTION__,
+                                               __LINE__));
+        }
+        return std::make_tuple(true,
+                               std::format("{}:{}:{}: indexFields: {}",
+                                           __FILE__,
+                                           __FUNCTION__,
+                                           __LINE__,
+                                           indexFields.size()));
+    }
+    return std::make_tuple(true, std::format("{}:{}:{}", __FILE__, __FUNCTION__, __LINE__));
+}
+
+/**
+ * @brief Rz_writeContext::getQList
+ *
+ * @param type <"search:<query>">
+ * @details "search:<query>": file basenames of the records containing all words of the
+ * query in the indexed fields
+ * @return QList<QString>
+ */
+QList<QString> Rz_writeContext::getQList(const QString &type)
+{
+    if (type.startsWith("search:"))
+    {
+        return search(type.mid(7));
+    }
+
+    QList<QString> list("blender");
+    return list;
+}
+
+std::tuple<bool, std::string> Rz_writeContext::setQMap(const QMap<QString, QString> &setQmap,
+                                                    const QString &type)
+{
+    return std::make_tuple(true, std::format("{}:{}:{}", __FILE__, __FUNCTION__, __LINE__));
+}
+
+QMap<QString, QString> Rz_writeContext::getQMap(const QString &type)
+{
+    return qMap;
+}
+
+std::optional<Rz_section> Rz_writeContext::sectionFromType(const QString &type) const
+{
+    for (std::size_t s = 0; s < Rz_metaRecord::sectionCount; ++s)
+    {
+        const auto &key = Rz_writeShared::sectionKeys[s];
+        if (type.contains(QLatin1String(key.data(), static_cast<qsizetype>(key.size()))))
+        {
+            return static_cast<Rz_section>(s);
+        }
+    }
+    return std::nullopt;
+}
+
+/**
+ * @brief Rz_writeContext::setQHash
+ *
+ * @param setQhash <key/value pairs of the section>
+ * @param type <"PICTURE", "EXIF", "IPTC", "XMP">, optional suffix ":merge"
+ * @details replaces the section of the current record; the first call after
+ * writeFile() starts a new record. In update mode a ":merge" section changes only
+ * the given keys of the existing output, other sections are replaced as a whole
+ * @return std::tuple<bool, std::string>
+ */
+std::tuple<bool, std::string> Rz_writeContext::setQHash(const QHash<QString, QString> &setQhash,
+                                                     const QString &type)
+{
+    const auto section = sectionFromType(type);
+    if (!section)
+    {
+        return std::make_tuple(false,
+                               std::format("{}:{}:{}: wrong parameter", __FILE__, __FUNCTION__, __LINE__));
+    }
+
+    closeParsed();
+    if (recordWritten)
+    {
+        record.clear();
+        mergeKeys.fill(false);
+        recordWritten = false;
+    }
+    mergeKeys[static_cast<std::size_t>(*section)] = type.contains(":merge");
+    record.beginSection(*section);
+    for (auto i = setQhash.cbegin(); i != setQhash.cend(); ++i)
+    {
+        if (!record.add(toText(i.key()), toText(i.value())))
+        {
+            record.endSection();
+            return std::make_tuple(false,
+                                   std::format("{}:{}:{}: the record exceeds {} bytes of keys and values",
+                                               __FILE__,
+                                               __FUNCTION__,
+                                               __LINE__,
+                                               Rz_metaRecord::maxBytes));
+        }
+    }
+    record.endSection();
+
+    return std::make_tuple(true,
+                           std::format("{}:{}: {}",
+                                       __FILE__,
+                                       __FUNCTION__,
+                                       Rz_writeShared::sectionKeys[static_cast<std::size_t>(*section)]));
+}
+
+/**
+ * @brief Rz_writeContext::getQHash
+ *
+ * @param type <"PICTURE", "EXIF", "IPTC", "XMP">, default "EXIF"
+ * @details in lazy mode after parseFile() only this section of the file is decoded
+ * @return QHash<QString, QString> <section of the current record>
+ */
+QHash<QString, QString> Rz_writeContext::getQHash(const QString &type)
+{
+    const Rz_section section = sectionFromType(type).value_or(Rz_section::EXIF);
+
+    QHash<QString, QString> hash;
+    if (parsedData != nullptr)
+    {
+        decodeParsed(section, [&hash](std::string_view key, std::string_view value) {
+            hash.insert(QString::fromUtf8(key.data(), static_cast<qsizetype>(key.size())),
+                        QString::fromUtf8(value.data(), static_cast<qsizetype>(value.size())));
+        });
+        return hash;
+    }
+
+    const auto entries = record.section(section);
+    hash.reserve(static_cast<qsizetype>(entries.size()));
+    for (const auto &entry : entries)
+    {
+        const auto key = record.key(entry);
+        const auto value = record.value(entry);
+        hash.insert(QString::fromUtf8(key.data(), static_cast<qsizetype>(key.size())),
+                    QString::fromUtf8(value.data(), static_cast<qsizetype>(value.size())));
+    }
+    return hash;
+}
@@ -0,0 +1,120 @@
+/**
+ * @file test_archive.cpp
+ * @author ZHENG Robert (robert.hase-zheng.net)
+ * @brief regression test of the archive: records and tombstones across a compaction
+ * @version 0.1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2025 ZHENG Robert
+ *
+ * usage: test_archive [records]
+ * records are appended, replaced and removed, then compacted while appends go on; the
+ * archive must read the same before, after and once reopened, with the superseded
+ * frames and the tombstones gone from the compacted segments
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <format>
+#include <map>
+#include <string>
+#include <thread>
+
+#include "includes/rz_archive.hpp"
+#include "includes/rz_test.hpp"
+
+namespace
+{
+// the archive as a reader sees it: the latest frame of every key, without tombstones
+std::map<std::string, std::string> live(const Rz_archive &archive, long &frames)
+{
+    std::map<std::string, std::string> records;
+    frames = 0;
+    archive.scan([&](const Rz_archiveFrame &frame) {
+        ++frames;
+        if (frame.type == Rz_archiveFrame::Tombstone)
+        {
+            records.erase(std::string(frame.key));
+            return;
+        }
+        records[std::string(frame.key)] = std::string(frame.payload);
+    });
+    return records;
+}
+
+bool waitForCompaction(const Rz_archive &archive)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+    while (archive.compacting() && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return !archive.compacting();
+}
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    const int records = std::max(10, argc > 1 ? std::atoi(argv[1]) : 2000);
+    Rz_testRun test("test_archive");
+    const std::string dir = test.directory().string();
+    std::map<std::string, std::string> expected;
+    long frames = 0;
+
+    auto archive = Rz_archive::open(dir);
+    test.check(archive && archive->isOpen(), "archive opened");
+    if (!archive || !archive->isOpen())
+    {
+        return test.result();
+    }
+
+    // every third record replaced, every fifth removed
+    bool ok = true;
+    for (int i = 0; i < records; ++i)
+    {
+        const std::string key = std::format("IMG_{}", i);
+        expected[key] = std::format("{{\"EXIF\":{{\"imagedescription\":\"version 1 of {}\"}}}}", i);
+        ok = archive->append(key, OutputFormat::JSON, expected[key]) && ok;
+    }
+    for (int i = 0; i < records; i += 3)
+    {
+        const std::string key = std::format("IMG_{}", i);
+        expected[key] = std::format("{{\"EXIF\":{{\"imagedescription\":\"version 2 of {}\"}}}}", i);
+        ok = archive->append(key, OutputFormat::JSON, expected[key]) && ok;
+    }
+    for (int i = 0; i < records; i += 5)
+    {
+        const std::string key = std::format("IMG_{}", i);
+        expected.erase(key);
+        ok = archive->remove(key) && ok;
+    }
+    test.check(ok, "appends and removals");
+    test.check(live(*archive, frames) == expected, std::format("live records before compaction: {}", expected.size()));
+
+    // appends and removals go on into a fresh segment while compacting
+    const long compacted = static_cast<long>(expected.size());
+    test.check(archive->startCompaction(0), "compaction started");
+    ok = true;
+    expected["IMG_1"] = "{\"EXIF\":{\"imagedescription\":\"version 3 of 1\"}}";
+    ok = archive->append("IMG_1", OutputFormat::JSON, expected["IMG_1"]) && ok;
+    expected["IMG_0"] = "{\"EXIF\":{\"imagedescription\":\"appended again\"}}";
+    ok = archive->append("IMG_0", OutputFormat::JSON, expected["IMG_0"]) && ok;
+    expected.erase("IMG_2");
+    ok = archive->remove("IMG_2") && ok;
+    test.check(ok, "appends during compaction");
+    test.check(waitForCompaction(*archive), "compaction finished");
+    test.check(!archive->report().empty(), std::format("report: {}", archive->report()));
+
+    test.check(live(*archive, frames) == expected, "live records after compaction");
+    test.check(frames == compacted + 3,
+               std::format("superseded frames and tombstones dropped: {} frames, {} expected", frames, compacted + 3));
+
+    // the manifest lists the compacted segments
+    archive.reset();
+    archive = Rz_archive::open(dir);
+    test.check(archive && live(*archive, frames) == expected, "live records after reopening");
+
+    return test.result();
+}
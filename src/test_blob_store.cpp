@@ -0,0 +1,68 @@
+/**
+ * @file test_blob_store.cpp
+ * @author ZHENG Robert (robert.hase-zheng.net)
+ * @brief regression test of the blob store: references per output format, reference
+ * counts and collect()
+ * @version 0.1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2025 ZHENG Robert
+ *
+ * usage: test_blob_store
+ *
+ */
+
+#include <format>
+#include <string>
+
+#include "includes/rz_blob_store.hpp"
+#include "includes/rz_test.hpp"
+
+int main()
+{
+    Rz_testRun test("test_blob_store");
+
+    test.check(Rz_blobStore::digest("abc") == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad",
+               "digest is SHA-256");
+
+    const auto store = Rz_blobStore::open(test.directory().string());
+    std::string error;
+    std::string json;
+    std::string cbor;
+    std::string data;
+
+    // one record exported as JSON and as CBOR: one reference per format
+    test.check(store->put("IMG_1", "EXIF", ".json", "{\"gpstag\":\"ACTIVE\"}", json, error), "put .json");
+    test.check(store->put("IMG_1", "EXIF", ".cbor", "\xa1" "fgpstagfACTIVE", cbor, error), "put .cbor");
+    test.check(store->references(".json", json) == 1 && store->references(".cbor", cbor) == 1,
+               "references of both formats");
+
+    // equal sections of two records share the blob
+    test.check(store->put("IMG_2", "EXIF", ".json", "{\"gpstag\":\"ACTIVE\"}", data, error) && data == json,
+               "put of an equal section");
+    test.check(store->references(".json", json) == 2, "shared blob counts both references");
+
+    // a new version of the section replaces the reference
+    std::string changed;
+    test.check(store->put("IMG_2", "EXIF", ".json", "{\"gpstag\":\"OFF\"}", changed, error), "put of a new version");
+    test.check(store->references(".json", json) == 1 && store->references(".json", changed) == 1,
+               "replaced reference released");
+
+    // releasing the JSON reference keeps the CBOR blob of the same record
+    test.check(store->release("IMG_1", "EXIF", ".json"), "release .json");
+    test.check(store->references(".json", json) == 0, "released blob unreferenced");
+    test.check(store->collect() == 1, "collect removes the unreferenced blob only");
+    test.check(store->references(".json", json) == -1, "collected blob gone");
+    test.check(store->get("IMG_1", "EXIF", ".cbor", cbor, data) && data == "\xa1" "fgpstagfACTIVE",
+               "CBOR section still readable");
+    test.check(store->get("IMG_2", "EXIF", ".json", changed, data) && data == "{\"gpstag\":\"OFF\"}",
+               "other record still readable");
+
+    // nothing left to collect while referenced
+    test.check(store->collect() == 0, "referenced blobs are kept");
+    test.check(store->release("IMG_1", "EXIF", ".cbor") && store->release("IMG_2", "EXIF", ".json")
+                   && store->collect() == 2,
+               "all blobs collected once released");
+
+    return test.result();
+}
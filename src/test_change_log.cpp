@@ -0,0 +1,108 @@
+/**
+ * @file test_change_log.cpp
+ * @author ZHENG Robert (robert.hase-zheng.net)
+ * @brief regression test of the change feed: patches and concurrent appends
+ * @version 0.1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2025 ZHENG Robert
+ *
+ * usage: test_change_log [lines per writer]
+ * every entry must patch the previous record into the new one; entries appended by
+ * several writers at once must stay whole lines
+ *
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "includes/rz_change_log.hpp"
+#include "includes/rz_test.hpp"
+
+namespace
+{
+constexpr int writers{8};
+
+// the entry applied to before gives after
+bool patches(const nlohmann::json &before, const nlohmann::json &after)
+{
+    const std::string line = Rz_changeLog::entry("IMG_1", before, after);
+    if (line.empty() || line.back() != '\n')
+    {
+        return false;
+    }
+    const auto entry = nlohmann::json::parse(line, nullptr, false);
+    if (entry.is_discarded() || entry.value("record", "") != "IMG_1" || !entry.contains("patch"))
+    {
+        return false;
+    }
+    const nlohmann::json base = before.is_object() ? before : nlohmann::json::object();
+    return base.patch(entry["patch"]) == after;
+}
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    const int lines = std::max(1, argc > 1 ? std::atoi(argv[1]) : 2000);
+    Rz_testRun test("test_change_log");
+    const std::filesystem::path dir = test.directory();
+
+    const nlohmann::json first{{"file_name", "IMG_1.jpg"},
+                               {"EXIF", {{"gpslatitude", "52.5200"}, {"gpstag", "ACTIVE"}}},
+                               {"XMP", {{"city", "Berlin"}}}};
+    nlohmann::json second = first;
+    second["EXIF"]["gpslatitude"] = "48.1";
+    second["EXIF"].erase("gpstag");
+    second["IPTC"] = {{"caption", "Abendlicht"}};
+
+    test.check(patches(nlohmann::json::object(), first), "new record: add of every member");
+    test.check(patches(nlohmann::json(), first), "no previous export");
+    test.check(patches(first, second), "changed, removed and added members");
+    test.check(Rz_changeLog::entry("IMG_1", first, first).empty(), "no entry without a change");
+
+    const auto removal = nlohmann::json::parse(Rz_changeLog::removal("IMG_1"), nullptr, false);
+    test.check(!removal.is_discarded() && removal.value("removed", false), "removal entry");
+
+    // writers of one folder append concurrently, each entry is one write
+    const auto log = Rz_changeLog::open(dir.string());
+    std::vector<std::thread> threads;
+    std::vector<int> failed(writers, 0);
+    for (int w = 0; w < writers; ++w)
+    {
+        threads.emplace_back([&, w] {
+            nlohmann::json after = first;
+            for (int i = 0; i < lines; ++i)
+            {
+                after["EXIF"]["imagedescription"] = std::string(static_cast<std::size_t>(i % 512), 'x');
+                failed[w] += log->append(Rz_changeLog::entry(std::format("IMG_{}_{}", w, i), first, after)) ? 0 : 1;
+            }
+        });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    test.check(std::count(failed.begin(), failed.end(), 0) == writers, "all appends succeeded");
+
+    std::ifstream in(log->path());
+    std::string line;
+    long whole = 0;
+    long broken = 0;
+    while (std::getline(in, line))
+    {
+        const auto entry = nlohmann::json::parse(line, nullptr, false);
+        (entry.is_discarded() || !entry.contains("patch") ? broken : whole) += 1;
+    }
+    test.check(broken == 0 && whole == static_cast<long>(writers) * lines,
+               std::format("whole lines: {} of {}, broken: {}", whole, writers * lines, broken));
+
+    return test.result();
+}
@@ -0,0 +1,76 @@
+/**
+ * @file test_checkpoint.cpp
+ * @author ZHENG Robert (robert.hase-zheng.net)
+ * @brief regression test of the checkpoint journal: resume set and torn tail
+ * @version 0.1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2025 ZHENG Robert
+ *
+ * usage: test_checkpoint
+ *
+ */
+
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "includes/rz_checkpoint.hpp"
+#include "includes/rz_test.hpp"
+
+namespace
+{
+std::string readAll(const std::string &path)
+{
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+} // namespace
+
+int main()
+{
+    Rz_testRun test("test_checkpoint");
+    const std::filesystem::path dir = test.directory();
+    const std::string journalPath = (dir / std::string(Rz_checkpoint::fileName)).string();
+
+    // first run: records completed by this run are written again when asked to
+    {
+        const auto journal = Rz_checkpoint::open(dir.string());
+        test.check(journal->isOpen(), "journal opened");
+        journal->complete("IMG_1.json");
+        journal->complete("IMG_2.json");
+        test.check(!journal->contains("IMG_1.json"), "no skip of a record completed by this run");
+        test.check(journal->flush(), "flush");
+    }
+    test.check(readAll(journalPath) == "IMG_1.json\nIMG_2.json\n", "one line per record");
+
+    // second run: the records of the first run are skipped, keyed by name and extension
+    {
+        const auto journal = Rz_checkpoint::open(dir.string());
+        test.check(journal->contains("IMG_1.json") && journal->contains("IMG_2.json"), "records of an earlier run skipped");
+        test.check(!journal->contains("IMG_1.cbor"), "other output format not skipped");
+        test.check(!journal->contains("IMG_3.json"), "unknown record not skipped");
+    }
+
+    // a batch torn by a crash: the partial last line is cut when the journal is opened
+    {
+        std::ofstream torn(journalPath, std::ios::binary | std::ios::app);
+        torn << "IMG_3.js";
+    }
+    {
+        const auto journal = Rz_checkpoint::open(dir.string());
+        test.check(readAll(journalPath) == "IMG_1.json\nIMG_2.json\n", "torn tail cut");
+        test.check(!journal->contains("IMG_3.js") && !journal->contains("IMG_3.json"), "torn record not skipped");
+        journal->complete("IMG_3.json");
+        test.check(journal->flush(), "flush after the cut");
+    }
+    test.check(readAll(journalPath) == "IMG_1.json\nIMG_2.json\nIMG_3.json\n", "next batch starts on a line of its own");
+    {
+        const auto journal = Rz_checkpoint::open(dir.string());
+        test.check(journal->contains("IMG_3.json"), "record of the batch after the cut skipped");
+    }
+
+    return test.result();
+}
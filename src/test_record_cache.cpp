@@ -0,0 +1,99 @@
+/**
+ * @file test_record_cache.cpp
+ * @author ZHENG Robert (robert.hase-zheng.net)
+ * @brief regression test of the record cache: memory cap and file stamps
+ * @version 0.1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2025 ZHENG Robert
+ *
+ * usage: test_record_cache
+ *
+ */
+
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include "includes/rz_meta_record.hpp"
+#include "includes/rz_record_cache.hpp"
+#include "includes/rz_test.hpp"
+
+namespace
+{
+constexpr std::size_t capacity{1024 * 1024};
+constexpr int records{1000};
+
+std::shared_ptr<const Rz_metaRecord> makeRecord(std::size_t valueSize)
+{
+    auto record = std::make_shared<Rz_metaRecord>();
+    const std::string value(valueSize, 'x');
+    record->beginSection(Rz_section::EXIF);
+    record->add(std::string_view("imagedescription"), std::string_view(value));
+    record->endSection();
+    return record;
+}
+
+// "bytes: <held> of <cap>" of the report
+std::size_t heldBytes(const std::string &report)
+{
+    const std::size_t at = report.find("bytes: ");
+    return at == std::string::npos ? 0 : std::stoull(report.substr(at + 7));
+}
+
+void writeFile(const std::string &path, const std::string &data)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << data;
+}
+} // namespace
+
+int main()
+{
+    Rz_testRun test("test_record_cache");
+    auto &cache = Rz_recordCache::instance();
+    cache.setCapacity(capacity);
+
+    // the cap holds while far more records are inserted than fit
+    for (int i = 0; i < records; ++i)
+    {
+        cache.insert(std::format("/cap/IMG_{}.json", i), {static_cast<std::uint64_t>(i), 1, 1}, makeRecord(8 * 1024));
+    }
+    const std::string report = cache.report();
+    test.check(heldBytes(report) > 0 && heldBytes(report) <= capacity, "memory cap: " + report);
+    test.check(cache.find(std::format("/cap/IMG_{}.json", records - 1), {records - 1, 1, 1}) != nullptr,
+               "most recent record kept");
+    test.check(cache.find("/cap/IMG_0.json", {0, 1, 1}) == nullptr, "least recently used record evicted");
+
+    // a record larger than its shard's share is not cached at all
+    cache.insert("/cap/large.json", {1, 1, 1}, makeRecord(capacity / Rz_recordCache::shardCount));
+    test.check(cache.find("/cap/large.json", {1, 1, 1}) == nullptr, "oversized record not cached");
+
+    // an entry is only valid for the file version it was decoded from
+    const std::filesystem::path dir = test.directory();
+    const std::string path = (dir / "IMG_1.json").string();
+    Rz_recordCache::Stamp before;
+    Rz_recordCache::Stamp after;
+    writeFile(path, "{\"EXIF\":{}}\n");
+    test.check(Rz_recordCache::stamp(path, before), "stamp of an existing file");
+    cache.insert(path, before, makeRecord(16));
+    test.check(cache.find(path, before) != nullptr, "hit while the file is unchanged");
+
+    writeFile(path, "{\"EXIF\":{\"gpstag\":\"ACTIVE\"}}\n");
+    test.check(Rz_recordCache::stamp(path, after) && !(after == before), "rewritten file gets a new stamp");
+    test.check(cache.find(path, after) == nullptr, "miss after the file changed");
+    test.check(cache.find(path, before) == nullptr, "stale entry dropped");
+
+    cache.insert(path, after, makeRecord(16));
+    cache.invalidate(path);
+    test.check(cache.find(path, after) == nullptr, "miss after invalidate()");
+    test.check(!Rz_recordCache::stamp((dir / "missing.json").string(), after), "no stamp of a missing file");
+
+    // capacity 0 switches the cache off and drops all records
+    cache.setCapacity(0);
+    test.check(heldBytes(cache.report()) == 0, "capacity 0 drops all records");
+
+    return test.result();
+}
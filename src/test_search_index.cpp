@@ -0,0 +1,102 @@
+/**
+ * @file test_search_index.cpp
+ * @author ZHENG Robert (robert.hase-zheng.net)
+ * @brief regression test of the search index: collected records, segments and merges
+ * @version 0.1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2025 ZHENG Robert
+ *
+ * usage: test_search_index [records]
+ * records are added, re-added with other values and flushed in several segments; a
+ * search has to find the latest version of every record, flushed or not, without
+ * writing the collected ones
+ *
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <string>
+#include <vector>
+
+#include "includes/rz_search_index.hpp"
+#include "includes/rz_test.hpp"
+
+namespace
+{
+std::vector<std::vector<std::string>> query(const std::vector<std::string> &tokens)
+{
+    std::vector<std::vector<std::string>> terms;
+    for (const auto &token : tokens)
+    {
+        terms.push_back({Rz_searchIndex::term("XMP.city", token), Rz_searchIndex::term("XMP.keywords", token)});
+    }
+    return terms;
+}
+
+long fileCount(const std::filesystem::path &dir)
+{
+    return std::distance(std::filesystem::directory_iterator(dir), std::filesystem::directory_iterator());
+}
+
+// records of one city: IMG_<i> for every i with i % cities == city
+std::vector<std::string> expected(int records, int cities, int city)
+{
+    std::vector<std::string> names;
+    for (int i = city; i < records; i += cities)
+    {
+        names.push_back(std::format("IMG_{}", i));
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    const int records = std::max(10, argc > 1 ? std::atoi(argv[1]) : 3000);
+    constexpr int cities{5};
+    Rz_testRun test("test_search_index");
+    const std::string dir = test.directory().string();
+
+    auto index = Rz_searchIndex::open(dir);
+    bool ok = true;
+    for (int i = 0; i < records; ++i)
+    {
+        ok = index->add(std::format("IMG_{}", i),
+                        {{"XMP.city", std::format("City{}", i % cities)}, {"XMP.keywords", "Beach Summer"}})
+             && ok;
+    }
+    test.check(ok, "records added");
+
+    // the last records are still collected in memory
+    const long files = fileCount(dir);
+    test.check(index->search(query({"city0"})) == expected(records, cities, 0),
+               "collected and flushed records found");
+    test.check(index->search(query({"beach", "city3"})) == expected(records, cities, 3), "all tokens of a query");
+    test.check(index->search(query({"winter"})).empty(), "unknown token");
+    test.check(fileCount(dir) == files, "search writes no segment");
+
+    // re-added records supersede their entries in the files, before and after a flush
+    ok = index->add("IMG_0", {{"XMP.city", "Hamburg"}, {"XMP.keywords", "Harbour"}});
+    ok = index->add("IMG_1", {{"XMP.city", "Hamburg"}, {"XMP.keywords", "Harbour"}}) && ok;
+    test.check(ok, "records re-added");
+    auto city0 = expected(records, cities, 0);
+    city0.erase(std::find(city0.begin(), city0.end(), "IMG_0"));
+    const std::vector<std::string> hamburg{"IMG_0", "IMG_1"};
+    test.check(index->search(query({"city0"})) == city0, "re-added record gone from its old terms");
+    test.check(index->search(query({"hamburg"})) == hamburg, "re-added record found by its new terms");
+    test.check(index->flush(), "flush");
+    test.check(index->search(query({"city0"})) == city0 && index->search(query({"hamburg"})) == hamburg,
+               "same results after the flush");
+
+    // a reader of the files sees the flushed index
+    Rz_searchIndexReader reader;
+    const bool opened = reader.open(dir);
+    test.check(opened && reader.lookup("XMP.city", "hamburg") == hamburg,
+               std::format("reader of {} files", reader.fileCount()));
+
+    return test.result();
+}
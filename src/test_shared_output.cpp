@@ -0,0 +1,260 @@
+/**
+ * @file test_shared_output.cpp
+ * @author ZHENG Robert (robert.hase-zheng.net)
+ * @brief regression test of the shared output: updates under lockOutput() published
+ * whole with writeShared(), directly and through writer contexts in shared mode
+ * @version 0.1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2025 ZHENG Robert
+ *
+ * usage: test_shared_output <plugin> [updates per writer]
+ * writers increment a counter file under lockOutput() and publish it with writeShared(),
+ * then contexts of the plugin merge their own key into the EXIF section of one record
+ * with setQstring("on", "shared") and "update"; readers check that every version they
+ * see is complete. No update may get lost and no temporary file may be left.
+ *
+ */
+
+#include <QCoreApplication>
+#include <QHash>
+#include <QPluginLoader>
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "includes/rz_photo-gallery_plugins.hpp"
+#include "includes/rz_shared_output.hpp"
+#include "includes/rz_test.hpp"
+
+namespace
+{
+constexpr int writers{4};
+constexpr int readers{2};
+// every version is the counter padded to one size, a torn read is shorter or mixed
+constexpr std::size_t width{4096};
+
+std::string version(long counter)
+{
+    const std::string digits = std::to_string(counter);
+    return std::string(width - digits.size(), '0') + digits;
+}
+
+bool complete(const std::string &data)
+{
+    return data.size() == width && data.find_first_not_of("0123456789") == std::string::npos;
+}
+
+std::string readAll(const std::string &path)
+{
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+long fileCount(const std::filesystem::path &dir)
+{
+    return std::distance(std::filesystem::directory_iterator(dir), std::filesystem::directory_iterator());
+}
+
+// readers take no lock, they count the versions that are not complete
+template<typename Complete>
+std::vector<std::thread> startReaders(const std::string &path,
+                                      const std::atomic<bool> &done,
+                                      std::atomic<long> &torn,
+                                      Complete complete)
+{
+    std::vector<std::thread> threads;
+    for (int r = 0; r < readers; ++r)
+    {
+        threads.emplace_back([&path, &done, &torn, complete] {
+            while (!done)
+            {
+                if (!complete(readAll(path)))
+                {
+                    ++torn;
+                }
+            }
+        });
+    }
+    return threads;
+}
+
+void joinAll(std::vector<std::thread> &threads)
+{
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+}
+
+void counterUpdates(Rz_testRun &test, int updates)
+{
+    const std::filesystem::path dir = test.directory() / "counter";
+    std::filesystem::create_directories(dir);
+    const std::string path = (dir / "counter.json").string();
+
+    std::string error;
+    test.check(writeShared(path, version(0), error),
+               std::format("initial version{}", error.empty() ? "" : ": " + error));
+
+    std::atomic<bool> done{false};
+    std::atomic<long> torn{0};
+    std::atomic<long> failedUpdates{0};
+    auto threads = startReaders(path, done, torn, complete);
+    std::vector<std::thread> updaters;
+    for (int w = 0; w < writers; ++w)
+    {
+        updaters.emplace_back([&] {
+            for (int i = 0; i < updates; ++i)
+            {
+                std::string error;
+                const int fd = lockOutput(path, error);
+                if (fd < 0)
+                {
+                    ++failedUpdates;
+                    continue;
+                }
+                // the locked file is the current version
+                std::string data(width, '\0');
+                const bool read = ::pread(fd, data.data(), width, 0) == static_cast<ssize_t>(width) && complete(data);
+                if (!read || !writeShared(path, version(std::stol(data) + 1), error))
+                {
+                    ++failedUpdates;
+                }
+                ::close(fd);
+            }
+        });
+    }
+    joinAll(updaters);
+    done = true;
+    joinAll(threads);
+
+    const std::string last = readAll(path);
+    test.check(failedUpdates == 0, std::format("counter: updates failed: {}", failedUpdates.load()));
+    test.check(torn == 0, std::format("counter: torn reads: {}", torn.load()));
+    test.check(complete(last) && std::stol(last) == static_cast<long>(writers) * updates,
+               std::format("counter: no lost update: {} of {}",
+                           complete(last) ? std::stol(last) : -1L,
+                           writers * updates));
+    test.check(fileCount(dir) == 1, std::format("counter: no temporary files left: {} files", fileCount(dir)));
+}
+
+void contextUpdates(Rz_testRun &test, Plugin *plugin, int updates)
+{
+    const std::filesystem::path dir = test.directory() / "context";
+    std::filesystem::create_directories(dir);
+    const QString outputDir = QString::fromStdString(dir.string());
+    const QString image = QStringLiteral("/pictures/images/IMG_1.jpg");
+    const std::string path = (dir / "IMG_1.json").string();
+
+    const auto newContext = [&](bool update) {
+        std::shared_ptr<Plugin> context = plugin->createContext();
+        if (context)
+        {
+            context->setQstring("", "JSON");
+            context->setQstring("on", "shared");
+            context->setQstring(update ? "on" : "off", "update");
+            context->setQstring(image, "imgStruct");
+        }
+        return context;
+    };
+
+    // the record the contexts update: PICTURE and XMP have to stay as they are
+    const auto first = newContext(false);
+    test.check(first != nullptr, "createContext");
+    if (!first)
+    {
+        return;
+    }
+    first->setQHash({{"file_name", "IMG_1.jpg"}, {"filesize", "12345"}}, "PICTURE");
+    first->setQHash({{"file_name", "IMG_1.jpg"}, {"gpstag", "ACTIVE"}}, "EXIF");
+    first->setQHash({{"file_name", "IMG_1.jpg"}, {"city", "Berlin"}}, "XMP");
+    test.check(std::get<0>(first->writeFile(outputDir)), "context: initial record");
+
+    const auto readable = [](const std::string &data) {
+        const auto record = nlohmann::json::parse(data, nullptr, false);
+        return !record.is_discarded() && record.value("filesize", "") == "12345" && record.contains("EXIF")
+               && record.contains("XMP") && record["XMP"].value("city", "") == "Berlin";
+    };
+    std::atomic<bool> done{false};
+    std::atomic<long> torn{0};
+    std::atomic<long> failedUpdates{0};
+    auto threads = startReaders(path, done, torn, readable);
+
+    // every context merges its own key, with values of changing size: sections grow,
+    // shrink and move the rest of the file
+    std::vector<std::thread> updaters;
+    for (int w = 0; w < writers; ++w)
+    {
+        updaters.emplace_back([&, w] {
+            const auto context = newContext(true);
+            for (int i = 0; i < updates; ++i)
+            {
+                const QString value = QString::number(i) + QString(i % 7 * 8, QLatin1Char('x'));
+                context->setQHash({{QStringLiteral("writer%1").arg(w), value}}, "EXIF:merge");
+                if (!std::get<0>(context->writeFile(outputDir)))
+                {
+                    ++failedUpdates;
+                }
+            }
+        });
+    }
+    joinAll(updaters);
+    done = true;
+    joinAll(threads);
+
+    test.check(failedUpdates == 0, std::format("context: updates failed: {}", failedUpdates.load()));
+    test.check(torn == 0, std::format("context: torn reads: {}", torn.load()));
+
+    const std::string last = readAll(path);
+    const auto record = nlohmann::json::parse(last, nullptr, false);
+    int kept = 0;
+    const std::string lastValue = std::to_string(updates - 1) + std::string((updates - 1) % 7 * 8, 'x');
+    for (int w = 0; w < writers; ++w)
+    {
+        kept += readable(last) && record["EXIF"].value(std::format("writer{}", w), "") == lastValue ? 1 : 0;
+    }
+    test.check(readable(last) && record["EXIF"].value("gpstag", "") == "ACTIVE",
+               "context: other keys and sections kept");
+    test.check(kept == writers, std::format("context: no lost update: {} of {} writers", kept, writers));
+    test.check(fileCount(dir) == 1, std::format("context: no temporary files left: {} files", fileCount(dir)));
+}
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    if (argc < 2)
+    {
+        std::cerr << "usage: test_shared_output <plugin> [updates per writer]\n";
+        return EXIT_FAILURE;
+    }
+    const int updates = std::max(1, argc > 2 ? std::atoi(argv[2]) : 200);
+    Rz_testRun test("test_shared_output");
+
+    counterUpdates(test, updates);
+
+    QPluginLoader loader(QString::fromLocal8Bit(argv[1]));
+    Plugin *plugin = qobject_cast<Plugin *>(loader.instance());
+    test.check(plugin != nullptr, std::format("plugin loaded: {}", loader.errorString().toStdString()));
+    if (plugin)
+    {
+        contextUpdates(test, plugin, updates);
+    }
+    return test.result();
+}
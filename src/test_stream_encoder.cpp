@@ -0,0 +1,185 @@
+/**
+ * @file test_stream_encoder.cpp
+ * @author ZHENG Robert (robert.hase-zheng.net)
+ * @brief regression test of the stream encoder: same bytes as nlohmann::json
+ * @version 0.1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2025 ZHENG Robert
+ *
+ * usage: test_stream_encoder
+ * records with UTF-8 and UTF-16 values larger than a chunk are encoded in every output
+ * format and compared with dump() / to_cbor() / to_msgpack() / ... of the same object,
+ * a run of invalid UTF-8 larger than a chunk has to be written as it is
+ *
+ */
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <format>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "includes/rz_stream_encoder.hpp"
+#include "includes/rz_test.hpp"
+
+namespace
+{
+struct StringSink : Rz_byteSink
+{
+    std::string data;
+
+    bool write(const char *bytes, std::size_t size) override
+    {
+        data.append(bytes, size);
+        return true;
+    }
+};
+
+std::string repeat(std::string_view text, std::size_t count)
+{
+    std::string out;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        out.append(text);
+    }
+    return out;
+}
+
+std::u16string repeat(std::u16string_view text, std::size_t count)
+{
+    std::u16string out;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        out.append(text);
+    }
+    return out;
+}
+
+void sortNodes(std::vector<Rz_streamEncoder::Node> &nodes)
+{
+    std::sort(nodes.begin(), nodes.end(), [](const auto &lhs, const auto &rhs) {
+        return Rz_streamEncoder::less(lhs.key, rhs.key);
+    });
+}
+
+std::string encode(OutputFormat fmt, const std::vector<Rz_streamEncoder::Node> &root)
+{
+    StringSink sink;
+    Rz_streamEncoder encoder(fmt, sink);
+    if (!encoder.encode(root) || !encoder.flush())
+    {
+        return {};
+    }
+    return sink.data;
+}
+
+std::string expected(OutputFormat fmt, const nlohmann::json &record)
+{
+    std::vector<std::uint8_t> bytes;
+    switch (fmt)
+    {
+    case OutputFormat::JSON:
+        return record.dump();
+    case OutputFormat::BSON:
+        bytes = nlohmann::json::to_bson(record);
+        break;
+    case OutputFormat::CBOR:
+        bytes = nlohmann::json::to_cbor(record);
+        break;
+    case OutputFormat::MSGPACK:
+        bytes = nlohmann::json::to_msgpack(record);
+        break;
+    case OutputFormat::UBJSON:
+        bytes = nlohmann::json::to_ubjson(record);
+        break;
+    case OutputFormat::BJDATA:
+        bytes = nlohmann::json::to_bjdata(record);
+        break;
+    }
+    return std::string(bytes.begin(), bytes.end());
+}
+
+constexpr std::array<std::pair<OutputFormat, std::string_view>, 6> formats{
+    {{OutputFormat::JSON, "JSON"},
+     {OutputFormat::BSON, "BSON"},
+     {OutputFormat::CBOR, "CBOR"},
+     {OutputFormat::MSGPACK, "MSGPACK"},
+     {OutputFormat::UBJSON, "UBJSON"},
+     {OutputFormat::BJDATA, "BJDATA"}}};
+} // namespace
+
+int main()
+{
+    Rz_testRun test("test_stream_encoder");
+
+    // values of several chunks, multi-byte code points across the chunk boundaries,
+    // characters JSON has to escape; the XMP values are QString (UTF-16) data
+    const std::string description = repeat("Abendlicht \xc3\xbc" "ber dem Meer \xe2\x82\xac \xf0\x9f\x98\x80 \"\\\n\t\x01 ",
+                                           Rz_streamEncoder::chunkSize / 16);
+    const std::u16string title = repeat(u"Sommer am Meer ä \U0001F600 ", Rz_streamEncoder::chunkSize / 8);
+    const std::string titleUtf8 = repeat("Sommer am Meer \xc3\xa4 \xf0\x9f\x98\x80 ", Rz_streamEncoder::chunkSize / 8);
+
+    std::vector<Rz_streamEncoder::Node> exif{{std::string_view("imagedescription"), std::string_view(description)},
+                                             {std::string_view("gpstag"), std::string_view("ACTIVE")}};
+    std::vector<Rz_streamEncoder::Node> xmp{{std::u16string_view(u"title"), std::u16string_view(title)},
+                                            {std::u16string_view(u"city"), std::u16string_view(u"Berlin")}};
+    sortNodes(exif);
+    sortNodes(xmp);
+    std::vector<Rz_streamEncoder::Node> root{{std::string_view("file_name"), std::string_view("IMG_1.jpg")},
+                                             {std::string_view("EXIF"), std::string_view(), &exif},
+                                             {std::string_view("XMP"), std::string_view(), &xmp}};
+    sortNodes(root);
+
+    const nlohmann::json record{{"file_name", "IMG_1.jpg"},
+                                {"EXIF", {{"imagedescription", description}, {"gpstag", "ACTIVE"}}},
+                                {"XMP", {{"title", titleUtf8}, {"city", "Berlin"}}}};
+
+    for (const auto &[fmt, name] : formats)
+    {
+        const std::string out = encode(fmt, root);
+        if (fmt == OutputFormat::CBOR)
+        {
+            // text larger than a chunk is an indefinite-length string, same value
+            test.check(!out.empty() && nlohmann::json::from_cbor(out, true, false) == record,
+                       std::format("{}: large record decodes to the same object", name));
+            continue;
+        }
+        test.check(!out.empty() && out == expected(fmt, record), std::format("{}: large record, same bytes", name));
+    }
+
+    // values within a chunk: the same bytes in every format
+    const std::vector<Rz_streamEncoder::Node> smallExif{{std::string_view("gpstag"), std::string_view("ACTIVE")},
+                                                  {std::string_view("imagedescription"),
+                                                   std::string_view("Ein sch\xc3\xb6nes Bild")}};
+    const std::vector<Rz_streamEncoder::Node> smallRoot{{std::string_view("EXIF"), std::string_view(), &smallExif}};
+    const nlohmann::json smallRecord{{"EXIF", {{"gpstag", "ACTIVE"}, {"imagedescription", "Ein sch\xc3\xb6nes Bild"}}}};
+    for (const auto &[fmt, name] : formats)
+    {
+        const std::string out = encode(fmt, smallRoot);
+        test.check(!out.empty() && out == expected(fmt, smallRecord), std::format("{}: small record, same bytes", name));
+    }
+
+    // a run of continuation bytes longer than a chunk has no code point boundary to cut
+    // at; the binary formats take the bytes as they are, as nlohmann does
+    const std::string invalid(Rz_streamEncoder::chunkSize + 16, '\x80');
+    const std::vector<Rz_streamEncoder::Node> invalidRoot{{std::string_view("comment"), std::string_view(invalid)}};
+    const nlohmann::json invalidRecord{{"comment", invalid}};
+    for (const auto &[fmt, name] : formats)
+    {
+        if (fmt == OutputFormat::JSON || fmt == OutputFormat::CBOR)
+        {
+            continue;
+        }
+        const std::string out = encode(fmt, invalidRoot);
+        test.check(!out.empty() && out == expected(fmt, invalidRecord),
+                   std::format("{}: invalid UTF-8 larger than a chunk, same bytes", name));
+    }
+
+    return test.result();
+}
@@ -0,0 +1,173 @@
+/**
+ * @file test_update.cpp
+ * @author ZHENG Robert (robert.hase-zheng.net)
+ * @brief regression test of the update mode: sections that grow and shrink
+ * @version 0.1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2025 ZHENG Robert
+ *
+ * usage: test_update <plugin> [updates]
+ * a record is written in every output format, then its EXIF section is updated with
+ * longer and shorter values in turn; every version has to decode to the record last
+ * written, and the file must not grow while the same values come back
+ *
+ */
+
+#include <QCoreApplication>
+#include <QHash>
+#include <QPluginLoader>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "includes/rz_photo-gallery_plugins.hpp"
+#include "includes/rz_test.hpp"
+
+namespace
+{
+constexpr std::array<const char *, 6> formats{"JSON", "BSON", "CBOR", "MSGPACK", "UBJSON", "BJDATA"};
+
+std::string readAll(const std::string &path)
+{
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+nlohmann::json decode(const std::string &format, const std::string &data)
+{
+    if (format == "JSON")
+    {
+        return nlohmann::json::parse(data, nullptr, false);
+    }
+    const std::vector<std::uint8_t> bytes(data.begin(), data.end());
+    if (format == "BSON")
+    {
+        return nlohmann::json::from_bson(bytes, true, false);
+    }
+    if (format == "CBOR")
+    {
+        return nlohmann::json::from_cbor(bytes, true, false);
+    }
+    if (format == "MSGPACK")
+    {
+        return nlohmann::json::from_msgpack(bytes, true, false);
+    }
+    if (format == "UBJSON")
+    {
+        return nlohmann::json::from_ubjson(bytes, true, false);
+    }
+    return nlohmann::json::from_bjdata(bytes, true, false);
+}
+
+// the record holds the description, the other sections are unchanged
+bool holds(const nlohmann::json &record, const std::string &description)
+{
+    return record.is_object() && record.value("filesize", "") == "12345" && record.contains("EXIF")
+           && record["EXIF"].value("imagedescription", "") == description
+           && record["EXIF"].value("gpstag", "") == "ACTIVE" && record.contains("XMP")
+           && record["XMP"].value("city", "") == "Berlin";
+}
+
+void updates(Rz_testRun &test, Plugin *plugin, const std::string &format, int rounds)
+{
+    const std::filesystem::path dir = test.directory() / format;
+    std::filesystem::create_directories(dir);
+    const QString outputDir = QString::fromStdString(dir.string());
+    std::shared_ptr<Plugin> context = plugin->createContext();
+    context->setQstring("", QString::fromStdString(format));
+    context->setQstring(QStringLiteral("/pictures/images/IMG_1.jpg"), "imgStruct");
+
+    const QString longText = QStringLiteral("Abendlicht über dem Meer ").repeated(16);
+    const QString shortText = QStringLiteral("kurz");
+    const QString longerText = longText.repeated(4);
+    const auto exif = [](const QString &description) {
+        return QHash<QString, QString>{{"file_name", "IMG_1.jpg"},
+                                       {"gpstag", "ACTIVE"},
+                                       {"imagedescription", description}};
+    };
+
+    context->setQHash({{"file_name", "IMG_1.jpg"}, {"filesize", "12345"}}, "PICTURE");
+    context->setQHash(exif(longText), "EXIF");
+    context->setQHash({{"file_name", "IMG_1.jpg"}, {"city", "Berlin"}}, "XMP");
+    test.check(std::get<0>(context->writeFile(outputDir)), std::format("{}: initial record", format));
+
+    std::string ext = format;
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+    const std::string path = (dir / ("IMG_1." + ext)).string();
+    context->setQstring("on", "update");
+
+    // shrink and grow back to the initial size, again and again: JSON keeps the padding
+    // of a shrunk section, the file is back at its initial size with every long value
+    const std::uintmax_t initialSize = std::filesystem::file_size(path);
+    std::uintmax_t size = initialSize;
+    bool decoded = true;
+    bool stable = true;
+    for (int i = 0; i < rounds && decoded; ++i)
+    {
+        const QString &description = i % 2 == 0 ? shortText : longText;
+        context->setQHash(exif(description), "EXIF");
+        decoded = std::get<0>(context->writeFile(outputDir))
+                  && holds(decode(format, readAll(path)), description.toStdString());
+        size = std::filesystem::file_size(path);
+        stable = stable && (description == shortText || size == initialSize);
+    }
+    test.check(decoded, std::format("{}: shrinking and growing section updated", format));
+    test.check(stable, std::format("{}: file size stable: {} bytes, initially {}", format, size, initialSize));
+
+    // grow beyond the initial size, then shrink and grow back to the grown size
+    context->setQHash(exif(longerText), "EXIF");
+    test.check(std::get<0>(context->writeFile(outputDir))
+                   && holds(decode(format, readAll(path)), longerText.toStdString()),
+               std::format("{}: growing section updated", format));
+    const std::uintmax_t grownSize = std::filesystem::file_size(path);
+    context->setQHash(exif(shortText), "EXIF");
+    decoded = std::get<0>(context->writeFile(outputDir))
+              && holds(decode(format, readAll(path)), shortText.toStdString());
+    context->setQHash(exif(longerText), "EXIF");
+    decoded = decoded && std::get<0>(context->writeFile(outputDir))
+              && holds(decode(format, readAll(path)), longerText.toStdString());
+    size = std::filesystem::file_size(path);
+    test.check(decoded && size == grownSize,
+               std::format("{}: shrunk and grown again: {} bytes, {} before", format, size, grownSize));
+}
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    if (argc < 2)
+    {
+        std::cerr << "usage: test_update <plugin> [updates]\n";
+        return EXIT_FAILURE;
+    }
+    const int rounds = std::max(2, argc > 2 ? std::atoi(argv[2]) : 20);
+    Rz_testRun test("test_update");
+
+    QPluginLoader loader(QString::fromLocal8Bit(argv[1]));
+    Plugin *plugin = qobject_cast<Plugin *>(loader.instance());
+    test.check(plugin != nullptr && plugin->createContext() != nullptr,
+               std::format("plugin loaded: {}", loader.errorString().toStdString()));
+    if (plugin && plugin->createContext())
+    {
+        for (const char *format : formats)
+        {
+            updates(test, plugin, format, rounds);
+        }
+    }
+    return test.result();
+}
@@ -14,9 +14,12 @@
 #include <QHash>
 #include <QPluginLoader>
 
+#include <chrono>
 #include <cstdlib>
 #include <exception>
 #include <iostream>
+#include <memory>
+#include <vector>
 
 #include <tuple>
 
@@ -31,6 +34,7 @@ void exit_handler();
 void terminate_handler();
 
 void getDetailedInfo();
+void measureContextCreation(Plugin *plugin);
 
 QPluginLoader loader;
 Plugin *plugin = nullptr;
@@ -76,6 +80,7 @@ int main()
     {
         qDebug() << "Plugin object OK";
         qDebug() << "Plugin: " << plugin->getPluginNameLong() << " " << plugin->getPluginVersion();
+        measureContextCreation(plugin);
     }
 
     QHash<QString, QString> pictureData{{"file_name", imgStruct.fileName},
@@ -176,6 +181,33 @@ void exit_handler()
     }
 }
 
+void measureContextCreation(Plugin *plugin)
+{
+    constexpr int count{10000};
+    std::vector<std::shared_ptr<Plugin>> contexts;
+    contexts.reserve(count);
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; ++i)
+    {
+        contexts.push_back(plugin->createContext());
+    }
+    const auto created = std::chrono::steady_clock::now();
+    contexts.clear();
+    const auto destroyed = std::chrono::steady_clock::now();
+
+    if (!plugin->createContext())
+    {
+        qDebug() << "createContext: not supported";
+        return;
+    }
+    const auto ns = [](auto duration) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count() / count;
+    };
+    std::cout << "createContext: " << ns(created - start) << " ns/context, destroy: "
+              << ns(destroyed - created) << " ns/context (" << count << " contexts)" << std::endl;
+}
+
 void terminate_handler()
 {
     std::cerr << "\n=terminated=\n";